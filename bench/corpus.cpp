@@ -0,0 +1,160 @@
+#include "corpus.hpp"
+
+#include <cstdint>
+#include <random>
+
+namespace bench {
+
+namespace {
+
+class Generator
+{
+public:
+	explicit Generator(std::uint32_t seed)
+		: engine_ { seed } {}
+
+	// Below bound, which is small, so the modulo bias does not matter.
+	std::uint32_t below(std::uint32_t bound)
+	{
+		return engine_() % bound;
+	}
+
+	std::string word()
+	{
+		static const char * const words[] = {
+			"request", "user", "session", "timeout", "cache", "error", "retry",
+			"database", "connection", "handler", "queue", "worker", "latency"
+		};
+		return words[below(sizeof words / sizeof *words)];
+	}
+
+	// Calls are kept in separate statements throughout, as the order of
+	// evaluation of operands is unspecified.
+	std::string number()
+	{
+		const auto kind = below(4);
+		const auto whole = below(2000000);
+		const auto fraction = below(1000);
+		const auto exponent = below(20);
+		switch (kind) {
+		case 0: return std::to_string(whole % 100);
+		case 1: return std::to_string(int(whole) - 1000000);
+		case 2: return std::to_string(whole / 20) + "." + std::to_string(fraction);
+		default:
+			return std::to_string(whole % 1000) + "." + std::to_string(fraction % 100)
+			       + "e-" + std::to_string(exponent);
+		}
+	}
+
+private:
+	std::mt19937 engine_;
+};
+
+std::string numeric_array(Generator & gen, std::size_t size)
+{
+	std::string text = "[";
+	while (text.size() < size) {
+		text += gen.number();
+		text += gen.below(8) ? ", " : ",\n";
+	}
+	text += "0]";
+	return text;
+}
+
+std::string string_logs(Generator & gen, std::size_t size)
+{
+	std::string text = "[\n";
+	for (std::uint32_t i = 0; text.size() < size; ++i) {
+		text += "  {\"ts\": " + std::to_string(1500000000 + i) + ", \"level\": \""
+		      + (gen.below(10) ? "info" : "error") + "\", \"message\": \"";
+		for (auto words = 4 + gen.below(16); words--; )
+			text += gen.word() + ' ';
+		if (!gen.below(4))
+			text += "caf\\u00e9 \\\"quoted\\\"\\n";
+		text += "\", \"host\": \"node-" + std::to_string(gen.below(64)) + "\"},\n";
+	}
+	text += "  {}\n]";
+	return text;
+}
+
+void nested_config(Generator & gen, std::string & text, unsigned depth, std::string indent)
+{
+	text += "{\n";
+	const auto inner = indent + "  ";
+	for (auto keys = 2 + gen.below(3); keys--; ) {
+		text += inner + '"' + gen.word() + std::to_string(keys) + "\": ";
+		if (depth && gen.below(3))
+			nested_config(gen, text, depth - 1, inner);
+		else if (gen.below(2))
+			text += '"' + gen.word() + '"';
+		else
+			text += "[" + gen.number() + ", true, null]";
+		text += keys ? ",\n" : "\n";
+	}
+	text += indent + "}";
+}
+
+std::string wide_object(Generator & gen, std::size_t size)
+{
+	std::string text = "{";
+	for (std::uint32_t i = 0; text.size() < size; ++i) {
+		text += "\"" + gen.word() + "_" + std::to_string(i) + "\": ";
+		text += gen.number() + ", ";
+	}
+	text += "\"last\": null}";
+	return text;
+}
+
+}
+
+std::vector<Document> make_corpus(std::size_t size)
+{
+	Generator gen { 20240611 };
+	std::vector<Document> corpus;
+	corpus.push_back({ "numeric_array", numeric_array(gen, size) });
+	corpus.push_back({ "string_logs", string_logs(gen, size) });
+	std::string config;
+	nested_config(gen, config, 12, "");
+	corpus.push_back({ "nested_config", config });
+	corpus.push_back({ "wide_object", wide_object(gen, size) });
+	return corpus;
+}
+
+std::string make_strings(std::size_t size)
+{
+	Generator gen { 7 };
+	std::string text;
+	while (text.size() < size) {
+		text += '"';
+		for (auto words = 1 + gen.below(6); words--; )
+			text += gen.word() + ' ';
+		if (!gen.below(8))
+			text += "\\t\\u00e9";
+		text += '"';
+	}
+	return text;
+}
+
+std::string make_numbers(std::size_t size)
+{
+	Generator gen { 11 };
+	std::string text;
+	while (text.size() < size)
+		text += gen.number() + ' ';
+	return text;
+}
+
+std::string make_whitespace(std::size_t size)
+{
+	Generator gen { 13 };
+	static const char spaces[] = { ' ', '\n', '\t', '\r' };
+	std::string text;
+	while (text.size() < size) {
+		for (auto count = gen.below(40); count--; )
+			text += spaces[gen.below(4)];
+		text += 'x';
+	}
+	return text;
+}
+
+}
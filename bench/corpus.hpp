@@ -0,0 +1,29 @@
+#ifndef REJSON_BENCH_CORPUS_HPP_
+#define REJSON_BENCH_CORPUS_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Document
+{
+	std::string name;
+	std::string text;
+};
+
+// Documents of the shapes being measured, generated from a fixed seed with
+// nothing but the raw output of mt19937, so that every platform gets the
+// same bytes. Each is about the given size, except for the nested config.
+std::vector<Document> make_corpus(std::size_t size);
+
+// Inputs for the lexer benchmarks: strings back to back, numbers and
+// whitespace runs between single letters.
+std::string make_strings(std::size_t size);
+std::string make_numbers(std::size_t size);
+std::string make_whitespace(std::size_t size);
+
+}
+
+#endif
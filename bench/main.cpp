@@ -0,0 +1,271 @@
+#include "corpus.hpp"
+
+#include <rejson/arena.hpp>
+#include <rejson/dump.hpp>
+#include <rejson/parse.hpp>
+#include <rejson/path.hpp>
+#include <rejson/value.hpp>
+#include <rejson/version.hpp>
+#include <rejson/detail/buffer.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every allocation made while a benchmark runs is counted, including those
+// made inside the library, which resolves operator new to these.
+namespace {
+
+std::size_t allocation_count = 0;
+
+}
+
+void * operator new(std::size_t size)
+{
+	++allocation_count;
+	if (void * ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+	double min_time = 0.5;
+	std::size_t corpus_size = 1 << 20;
+	std::string filter;
+};
+
+// What a single iteration of a benchmark processes.
+struct Workload
+{
+	std::size_t bytes;
+	std::size_t documents;
+};
+
+struct Result
+{
+	std::string name;
+	Workload workload;
+	std::size_t iterations;
+	double seconds;
+	std::size_t allocations;
+};
+
+// Handler ignoring every event, for measuring the lexer alone.
+struct NullHandler
+{
+	void on_null() {}
+	void on_bool(rejson::Bool) {}
+	void on_int(rejson::Int) {}
+	void on_real(rejson::Real) {}
+	void on_string(rejson::detail::string_view) {}
+	void on_key(rejson::detail::string_view) {}
+	void on_array_begin() {}
+	void on_array_end(std::size_t) {}
+	void on_object_begin() {}
+	void on_object_end(std::size_t) {}
+};
+
+class Runner
+{
+public:
+	explicit Runner(const Options & options)
+		: options_ (options) {}
+
+	// Runs the body once to warm up, then until the minimum time is spent.
+	void run(const std::string & name, Workload workload,
+	         const std::function<void ()> & body)
+	{
+		if (name.find(options_.filter) == std::string::npos)
+			return;
+		body();
+		const auto allocations = allocation_count;
+		std::size_t iterations = 0;
+		const auto start = Clock::now();
+		std::chrono::duration<double> elapsed {};
+		do {
+			body();
+			++iterations;
+			elapsed = Clock::now() - start;
+		} while (elapsed.count() < options_.min_time);
+		results_.push_back({ name, workload, iterations, elapsed.count(),
+		                     allocation_count - allocations });
+		std::cerr << name << ": " << iterations << " iterations\n";
+	}
+
+	rejson::Value report() const;
+
+private:
+	const Options & options_;
+	std::vector<Result> results_;
+};
+
+rejson::Value Runner::report() const
+{
+	rejson::Array benchmarks;
+	for (auto && result : results_) {
+		const double iterations = result.iterations;
+		const double bytes = result.workload.bytes * iterations;
+		const double documents = result.workload.documents * iterations;
+		rejson::Object entry;
+		entry.emplace("name", result.name);
+		entry.emplace("iterations", rejson::Int(result.iterations));
+		entry.emplace("seconds", result.seconds);
+		entry.emplace("bytes_per_iteration", rejson::Int(result.workload.bytes));
+		entry.emplace("mb_per_s", bytes ? rejson::Value(bytes / result.seconds / 1e6)
+		                                 : rejson::Value(nullptr));
+		entry.emplace("docs_per_s", documents / result.seconds);
+		entry.emplace("allocs_per_doc", result.allocations / documents);
+		benchmarks.push_back(std::move(entry));
+	}
+	rejson::Object report;
+	report.emplace("version", std::to_string(REJSON_VERSION_MAJOR) + "."
+	               + std::to_string(REJSON_VERSION_MINOR) + "."
+	               + std::to_string(REJSON_VERSION_PATCH));
+	report.emplace("min_time", options_.min_time);
+	report.emplace("corpus_size", rejson::Int(options_.corpus_size));
+	report.emplace("benchmarks", std::move(benchmarks));
+	return report;
+}
+
+void lexer_benchmarks(Runner & runner, std::size_t size)
+{
+	using namespace rejson::detail;
+	const auto strings = bench::make_strings(size);
+	const PaddedBuffer string_buffer { string_view(strings.data(), strings.size()) };
+	runner.run("lexer/parse_string", { strings.size(), 1 }, [&] {
+		std::string scratch;
+		const char * const end = string_buffer.end();
+		for (const char * pos = string_buffer.begin(); pos != end; )
+			buffer::parse_string(pos, end, scratch);
+	});
+
+	const auto numbers = bench::make_numbers(size);
+	const PaddedBuffer number_buffer { string_view(numbers.data(), numbers.size()) };
+	runner.run("lexer/parse_number", { numbers.size(), 1 }, [&] {
+		NullHandler handler;
+		const char * const end = number_buffer.end();
+		for (const char * pos = number_buffer.begin(); pos != end; ++pos)
+			buffer::parse_number(pos, end, handler);
+	});
+
+	const auto spaces = bench::make_whitespace(size);
+	const PaddedBuffer space_buffer { string_view(spaces.data(), spaces.size()) };
+	runner.run("lexer/skip_whitespace", { spaces.size(), 1 }, [&] {
+		const char * const end = space_buffer.end();
+		for (const char * pos = space_buffer.begin(); pos != end; ++pos)
+			buffer::skip_whitespace(pos);
+	});
+}
+
+void path_benchmarks(Runner & runner, const std::vector<bench::Document> & corpus)
+{
+	const auto logs = rejson::parse(corpus[1].text);
+	const auto wide = rejson::parse(corpus[3].text);
+	const rejson::Path message { "[100].message" };
+	const rejson::Path last { "last" };
+	runner.run("path/resolve_index_key", { 0, 1 }, [&] {
+		if (!message.resolve(logs))
+			std::abort();
+	});
+	runner.run("path/resolve_wide_object", { 0, 1 }, [&] {
+		if (!last.resolve(wide))
+			std::abort();
+	});
+	runner.run("path/get_cached", { 0, 1 }, [&] {
+		if (!rejson::get(logs, "[100].host"))
+			std::abort();
+	});
+}
+
+void parse_benchmarks(Runner & runner, const std::vector<bench::Document> & corpus)
+{
+	for (auto && document : corpus) {
+		const rejson::detail::string_view text { document.text.data(), document.text.size() };
+		const Workload workload { text.size(), 1 };
+		runner.run("parse/" + document.name, workload, [&] {
+			rejson::parse(text);
+		});
+		runner.run("parse_arena/" + document.name, workload, [&] {
+			rejson::Arena arena;
+			rejson::parse(text, arena);
+		});
+		runner.run("parse_sax/" + document.name, workload, [&] {
+			NullHandler handler;
+			rejson::parse(text, handler);
+		});
+		runner.run("parse_indexed_sax/" + document.name, workload, [&] {
+			NullHandler handler;
+			rejson::parse_indexed(text, handler);
+		});
+	}
+}
+
+int usage(const char * program)
+{
+	std::cerr << "usage: " << program
+	          << " [--filter text] [--min-time seconds] [--corpus-size bytes]\n";
+	return 2;
+}
+
+}
+
+// Prints the results as JSON on stdout, and progress on stderr.
+int main(int argc, char ** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 == argc)
+			return usage(argv[0]);
+		const char * const value = argv[++i];
+		if (std::strcmp(argv[i - 1], "--filter") == 0)
+			options.filter = value;
+		else if (std::strcmp(argv[i - 1], "--min-time") == 0)
+			options.min_time = std::atof(value);
+		else if (std::strcmp(argv[i - 1], "--corpus-size") == 0)
+			options.corpus_size = std::strtoull(value, nullptr, 10);
+		else
+			return usage(argv[0]);
+	}
+	Runner runner { options };
+	const auto corpus = bench::make_corpus(options.corpus_size);
+	lexer_benchmarks(runner, options.corpus_size);
+	path_benchmarks(runner, corpus);
+	parse_benchmarks(runner, corpus);
+	std::cout << rejson::dump(runner.report(), 2) << '\n';
+}
@@ -0,0 +1,129 @@
+#ifndef REJSON_ARENA_HPP_
+#define REJSON_ARENA_HPP_
+
+#include <rejson/export.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace rejson {
+
+class REJSON_EXPORT Arena
+{
+public:
+	Arena() noexcept;
+	explicit Arena(std::size_t block_size) noexcept;
+	~Arena();
+
+	Arena(const Arena &) = delete;
+	Arena & operator=(const Arena &) = delete;
+
+	void * allocate(std::size_t size, std::size_t alignment);
+
+	void release() noexcept;
+
+private:
+	struct Block;
+
+	void * allocate_block(std::size_t size, std::size_t alignment);
+
+	Block * blocks_;
+	char * pos_;
+	char * end_;
+	std::size_t block_size_;
+};
+
+inline void * Arena::allocate(std::size_t size, std::size_t alignment)
+{
+	const auto pos = reinterpret_cast<std::uintptr_t>(pos_);
+	const auto start = (pos + alignment - 1) & ~(alignment - 1);
+	if (pos_ && start + size <= reinterpret_cast<std::uintptr_t>(end_)) {
+		pos_ = reinterpret_cast<char *>(start + size);
+		return reinterpret_cast<void *>(start);
+	}
+	return allocate_block(size, alignment);
+}
+
+template <class T>
+class Allocator
+{
+public:
+	using value_type = T;
+
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	Allocator() noexcept = default;
+	Allocator(Arena * arena) noexcept;
+
+	template <class U>
+	Allocator(const Allocator<U> & other) noexcept;
+
+	T * allocate(std::size_t n);
+	void deallocate(T * ptr, std::size_t n) noexcept;
+
+	Allocator select_on_container_copy_construction() const noexcept;
+
+	Arena * arena() const noexcept;
+
+private:
+	Arena * arena_ = nullptr;
+};
+
+template <class T>
+Allocator<T>::Allocator(Arena * arena) noexcept
+	: arena_ { arena } {}
+
+template <class T>
+template <class U>
+Allocator<T>::Allocator(const Allocator<U> & other) noexcept
+	: arena_ { other.arena() } {}
+
+template <class T>
+T * Allocator<T>::allocate(std::size_t n)
+{
+	if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+		throw std::bad_alloc();
+	if (arena_)
+		return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+	return static_cast<T *>(::operator new(n * sizeof(T)));
+}
+
+template <class T>
+void Allocator<T>::deallocate(T * ptr, std::size_t) noexcept
+{
+	if (!arena_)
+		::operator delete(ptr);
+}
+
+template <class T>
+Allocator<T> Allocator<T>::select_on_container_copy_construction() const noexcept
+{
+	return {};
+}
+
+template <class T>
+Arena * Allocator<T>::arena() const noexcept
+{
+	return arena_;
+}
+
+template <class T, class U>
+bool operator==(const Allocator<T> & lhs, const Allocator<U> & rhs) noexcept
+{
+	return lhs.arena() == rhs.arena();
+}
+
+template <class T, class U>
+bool operator!=(const Allocator<T> & lhs, const Allocator<U> & rhs) noexcept
+{
+	return !(lhs == rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,503 @@
+#ifndef REJSON_DETAIL_BUFFER_HPP_
+#define REJSON_DETAIL_BUFFER_HPP_
+
+#include <rejson/error.hpp>
+#include <rejson/value.hpp>
+#include <rejson/detail/ctype.hpp>
+#include <rejson/detail/number.hpp>
+#include <rejson/detail/simd.hpp>
+#include <rejson/detail/string_view.hpp>
+#include <rejson/detail/utf8.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace rejson { namespace detail {
+
+// Number of zeroed bytes that must follow the input of the buffer engine.
+// The lexer relies on them to read ahead without checking for the end.
+constexpr std::size_t buffer_padding = 64;
+
+class PaddedBuffer
+{
+public:
+	explicit PaddedBuffer(string_view sv);
+
+	PaddedBuffer(const PaddedBuffer &) = delete;
+	PaddedBuffer & operator=(const PaddedBuffer &) = delete;
+
+	const char * begin() const;
+	const char * end() const;
+
+	// The copy belongs to the buffer, so its owner may change it in place.
+	char * data();
+
+private:
+	static constexpr std::size_t inline_size = 1024;
+
+	std::size_t size_;
+	std::unique_ptr<char []> heap_;
+	char inline_[inline_size + buffer_padding];
+};
+
+inline PaddedBuffer::PaddedBuffer(string_view sv)
+	: size_ { sv.size() }
+{
+	char * data = inline_;
+	if (size_ > inline_size) {
+		heap_.reset(new char[size_ + buffer_padding]);
+		data = heap_.get();
+	}
+	std::memcpy(data, sv.data(), size_);
+	std::memset(data + size_, 0, buffer_padding);
+}
+
+inline const char * PaddedBuffer::begin() const
+{
+	return heap_ ? heap_.get() : inline_;
+}
+
+inline const char * PaddedBuffer::end() const
+{
+	return begin() + size_;
+}
+
+inline char * PaddedBuffer::data()
+{
+	return heap_ ? heap_.get() : inline_;
+}
+
+namespace buffer {
+
+template <class Handler>
+void parse_value(const char *& pos, const char * end, Handler & handler);
+
+[[noreturn]] inline void fail(const char * pos, const char * end,
+                              const char * what)
+{
+	if (pos >= end)
+		throw ParseError("unexpected end of input");
+	throw ParseError(what);
+}
+
+inline void consume(const char *& pos, const char * end, char token)
+{
+	using namespace std::literals::string_literals;
+	if (*pos != token) {
+		if (pos >= end)
+			throw ParseError("unexpected end of input");
+		throw ParseError("expected '"s + token + "' token");
+	}
+	++pos;
+}
+
+inline bool try_consume(const char *& pos, const char * token,
+                        std::size_t length)
+{
+	if (std::memcmp(pos, token, length) != 0)
+		return false;
+	pos += length;
+	return true;
+}
+
+constexpr bool is_digit(char chr)
+{
+	return chr >= '0' && chr <= '9';
+}
+
+inline void skip_whitespace(const char *& pos)
+{
+	pos = skip_spaces(pos);
+}
+
+inline void parse_literal(const char *& pos, const char * end,
+                          const char * token, std::size_t length)
+{
+	if (!try_consume(pos, token, length))
+		fail(pos, end, "invalid value");
+}
+
+inline int parse_xdigit(char chr)
+{
+	if (is_digit(chr))
+		return chr - '0';
+	if (chr >= 'a' && chr <= 'f')
+		return 10 + (chr - 'a');
+	if (chr >= 'A' && chr <= 'F')
+		return 10 + (chr - 'A');
+	return -1;
+}
+
+inline bool try_parse_codept(const char *& pos, char32_t & code_pt)
+{
+	if (pos[0] != '\\' || pos[1] != 'u')
+		return false;
+	const int d0 = parse_xdigit(pos[2]), d1 = parse_xdigit(pos[3]),
+	          d2 = parse_xdigit(pos[4]), d3 = parse_xdigit(pos[5]);
+	if ((d0 | d1 | d2 | d3) < 0)
+		return false;
+	code_pt = d0 << 12 | d1 << 8 | d2 << 4 | d3;
+	pos += 6;
+	return true;
+}
+
+inline void parse_escaped(const char *& pos, const char * end,
+                          std::string & str)
+{
+	char32_t code_pt;
+	if (try_parse_codept(pos, code_pt)) {
+		char32_t low_pt;
+		const char * low_pos = pos;
+		if (in_range(code_pt, U'\xd800', U'\xdbff')
+		    && try_parse_codept(low_pos, low_pt)
+		    && in_range(low_pt, U'\xdc00', U'\xdfff')) {
+			code_pt = 0x10000 + ((code_pt - 0xd800) << 10)
+			                  + (low_pt - 0xdc00);
+			pos = low_pos;
+		}
+		return append_utf8(code_pt, str);
+	}
+	if (++pos >= end)
+		throw ParseError("unexpected end of input");
+	switch (const char chr = *pos++) {
+	case 'b': str += '\b'; break;
+	case 'f': str += '\f'; break;
+	case 'n': str += '\n'; break;
+	case 'r': str += '\r'; break;
+	case 't': str += '\t'; break;
+	default:  str += chr;
+	}
+}
+
+// Returns the decoded string, which points into the input unless the
+// string has escape sequences, in which case it is decoded into scratch.
+inline string_view parse_string(const char *& pos, const char * end,
+                                std::string & scratch)
+{
+	consume(pos, end, '"');
+	const char * run = pos;
+	pos = find_string_delimiter(pos);
+	if (*pos == '"')
+		return string_view(run, pos++ - run);
+	scratch.assign(run, pos);
+	for (;;) {
+		switch (*pos) {
+		case '"':
+			++pos;
+			return string_view(scratch.data(), scratch.size());
+		case '\\':
+			parse_escaped(pos, end, scratch);
+			break;
+		default:
+			fail(pos, end, "unescaped data in string");
+		}
+		run = pos;
+		pos = find_string_delimiter(pos);
+		scratch.append(run, pos);
+	}
+}
+
+template <class Handler>
+void parse_array(const char *& pos, const char * end, Handler & handler)
+{
+	std::size_t size = 0;
+	consume(pos, end, '[');
+	handler.on_array_begin();
+	skip_whitespace(pos);
+	if (*pos == ']') {
+		++pos;
+		handler.on_array_end(size);
+		return;
+	}
+	for (;;) {
+		parse_value(pos, end, handler);
+		++size;
+		skip_whitespace(pos);
+		switch (*pos) {
+		case ',':
+			skip_whitespace(++pos);
+			if (*pos == ',' || *pos == ']')
+				throw ParseError("unexpected ',' token");
+			break;
+		case ']':
+			++pos;
+			handler.on_array_end(size);
+			return;
+		default:
+			fail(pos, end, "expected ',' or ']' token");
+		}
+	}
+}
+
+template <class Handler>
+void parse_pair(const char *& pos, const char * end, Handler & handler)
+{
+	std::string scratch;
+	handler.on_key(parse_string(pos, end, scratch));
+	skip_whitespace(pos);
+	consume(pos, end, ':');
+	parse_value(pos, end, handler);
+}
+
+template <class Handler>
+void parse_object(const char *& pos, const char * end, Handler & handler)
+{
+	std::size_t size = 0;
+	consume(pos, end, '{');
+	handler.on_object_begin();
+	skip_whitespace(pos);
+	if (*pos == '}') {
+		++pos;
+		handler.on_object_end(size);
+		return;
+	}
+	for (;;) {
+		parse_pair(pos, end, handler);
+		++size;
+		skip_whitespace(pos);
+		switch (*pos) {
+		case ',':
+			skip_whitespace(++pos);
+			if (*pos == ',' || *pos == '}')
+				throw ParseError("unexpected ',' token");
+			break;
+		case '}':
+			++pos;
+			handler.on_object_end(size);
+			return;
+		default:
+			fail(pos, end, "expected ',' or '}' token");
+		}
+	}
+}
+
+template <class Handler>
+void parse_number(const char *& pos, const char * end, Handler & handler)
+{
+	const bool negative = *pos == '-';
+	pos += negative;
+	if (!is_digit(*pos))
+		fail(pos, end, "invalid value");
+	const char * const int_begin = pos;
+	std::uint64_t magnitude = 0;
+	pos = parse_digits(pos, magnitude);
+	const char * const int_end = pos;
+	if (*int_begin == '0' && int_end - int_begin > 1)
+		throw ParseError("invalid value");
+	const char * frac_begin = pos;
+	const bool has_frac = *pos == '.';
+	if (has_frac) {
+		frac_begin = ++pos;
+		if (!is_digit(*pos))
+			fail(pos, end, "invalid value");
+		while (is_digit(*pos))
+			++pos;
+	}
+	const char * const frac_end = pos;
+	long long exp = 0;
+	const bool has_exp = *pos == 'e' || *pos == 'E';
+	if (has_exp) {
+		const bool exp_negative = *++pos == '-';
+		pos += exp_negative || *pos == '+';
+		if (!is_digit(*pos))
+			fail(pos, end, "invalid value");
+		for (; is_digit(*pos); ++pos) {
+			if (exp < max_decimal_exponent)
+				exp = exp * 10 + (*pos - '0');
+		}
+		exp = exp_negative ? -exp : exp;
+	}
+	Int dec;
+	if (!has_frac && !has_exp
+	    && try_make_int(negative, magnitude, int_end - int_begin, dec)) {
+		handler.on_int(dec);
+		return;
+	}
+	const Real real = make_real(int_begin, int_end, frac_begin, frac_end, exp);
+	handler.on_real(negative ? -real : real);
+}
+
+template <class Handler>
+void parse_value(const char *& pos, const char * end, Handler & handler)
+{
+	skip_whitespace(pos);
+	switch (*pos) {
+	case 'n':
+		parse_literal(pos, end, "null", 4);
+		handler.on_null();
+		return;
+	case 't':
+		parse_literal(pos, end, "true", 4);
+		handler.on_bool(true);
+		return;
+	case 'f':
+		parse_literal(pos, end, "false", 5);
+		handler.on_bool(false);
+		return;
+	case '"': {
+		std::string scratch;
+		handler.on_string(parse_string(pos, end, scratch));
+		return;
+	}
+	case '[': return parse_array(pos, end, handler);
+	case '{': return parse_object(pos, end, handler);
+	default:  return parse_number(pos, end, handler);
+	}
+}
+
+// Skips a string without decoding it, rejecting what parse_string does.
+inline void skip_string(const char *& pos, const char * end)
+{
+	consume(pos, end, '"');
+	for (;;) {
+		pos = find_string_delimiter(pos);
+		switch (*pos) {
+		case '"':
+			++pos;
+			return;
+		case '\\':
+			if (++pos >= end)
+				throw ParseError("unexpected end of input");
+			++pos;
+			break;
+		default:
+			fail(pos, end, "unescaped data in string");
+		}
+	}
+}
+
+inline void skip_number(const char *& pos, const char * end)
+{
+	pos += *pos == '-';
+	if (!is_digit(*pos))
+		fail(pos, end, "invalid value");
+	const char * const int_begin = pos;
+	while (is_digit(*pos))
+		++pos;
+	if (*int_begin == '0' && pos - int_begin > 1)
+		throw ParseError("invalid value");
+	if (*pos == '.') {
+		if (!is_digit(*++pos))
+			fail(pos, end, "invalid value");
+		while (is_digit(*pos))
+			++pos;
+	}
+	if (*pos == 'e' || *pos == 'E') {
+		++pos;
+		pos += *pos == '-' || *pos == '+';
+		if (!is_digit(*pos))
+			fail(pos, end, "invalid value");
+		while (is_digit(*pos))
+			++pos;
+	}
+}
+
+// Skips a value, rejecting exactly what parse_value does, without
+// allocating or converting anything.
+inline void skip_value(const char *& pos, const char * end)
+{
+	skip_whitespace(pos);
+	switch (*pos) {
+	case 'n': return parse_literal(pos, end, "null", 4);
+	case 't': return parse_literal(pos, end, "true", 4);
+	case 'f': return parse_literal(pos, end, "false", 5);
+	case '"': return skip_string(pos, end);
+	case '[':
+	case '{': {
+		const char close = *pos == '[' ? ']' : '}';
+		skip_whitespace(++pos);
+		if (*pos == close) {
+			++pos;
+			return;
+		}
+		for (;;) {
+			if (close == '}') {
+				skip_whitespace(pos);
+				skip_string(pos, end);
+				skip_whitespace(pos);
+				consume(pos, end, ':');
+			}
+			skip_value(pos, end);
+			skip_whitespace(pos);
+			if (*pos == close) {
+				++pos;
+				return;
+			}
+			if (*pos != ',')
+				fail(pos, end, close == ']' ? "expected ',' or ']' token"
+				                            : "expected ',' or '}' token");
+			skip_whitespace(++pos);
+			if (*pos == ',' || *pos == close)
+				throw ParseError("unexpected ',' token");
+		}
+	}
+	default:
+		return skip_number(pos, end);
+	}
+}
+
+// Skips a value looking only at brackets and strings. Malformed input is
+// not noticed, except for running out of it.
+inline void skip_value_unchecked(const char *& pos, const char * end)
+{
+	skip_whitespace(pos);
+	std::size_t depth = 0;
+	for (;;) {
+		switch (*pos) {
+		case '"':
+			for (pos = find_string_delimiter(pos + 1); *pos != '"';
+			     pos = find_string_delimiter(pos)) {
+				if (pos >= end)
+					throw ParseError("unexpected end of input");
+				pos += *pos == '\\' ? 2 : 1;
+			}
+			++pos;
+			if (depth == 0)
+				return;
+			break;
+		case '[':
+		case '{':
+			++depth;
+			++pos;
+			break;
+		case ']':
+		case '}':
+			if (depth == 0)
+				return;
+			++pos;
+			if (--depth == 0)
+				return;
+			break;
+		case ',':
+		case ':':
+			if (depth == 0)
+				return;
+			++pos;
+			break;
+		default:
+			if (depth == 0 && (pos >= end || is_space(*pos)))
+				return;
+			if (pos >= end)
+				throw ParseError("unexpected end of input");
+			++pos;
+		}
+	}
+}
+
+// Buffer is PaddedBuffer, or anything else whose end is followed by
+// buffer_padding zero bytes.
+template <class Buffer, class Handler>
+void parse(const Buffer & buffer, Handler & handler)
+{
+	const char * pos = buffer.begin();
+	parse_value(pos, buffer.end(), handler);
+}
+
+}
+
+} }
+
+#endif
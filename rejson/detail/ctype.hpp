@@ -0,0 +1,40 @@
+#ifndef REJSON_DETAIL_CTYPE_HPP_
+#define REJSON_DETAIL_CTYPE_HPP_
+
+#include <type_traits>
+
+namespace rejson { namespace detail {
+
+template <typename T, typename Min, typename Max>
+constexpr bool in_range(T x, Min min, Max max)
+{
+	return x >= min && x <= max;
+}
+
+template <typename Char>
+constexpr auto to_code_unit(Char chr)
+{
+	return static_cast<std::make_unsigned_t<Char>>(chr);
+}
+
+template <typename Char>
+constexpr bool is_space(Char chr)
+{
+	return chr == ' ' || chr == '\n' || chr == '\r' || chr == '\t';
+}
+
+template <typename Char>
+constexpr bool is_control(Char chr)
+{
+	return to_code_unit(chr) < 0x20;
+}
+
+template <typename Char>
+constexpr bool is_string_delimiter(Char chr)
+{
+	return is_control(chr) || chr == '"' || chr == '\\';
+}
+
+} }
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef REJSON_DETAIL_DTOA_HPP_
+#define REJSON_DETAIL_DTOA_HPP_
+
+#include <rejson/export.h>
+
+namespace rejson { namespace detail {
+
+// Enough room for any output of format_real().
+constexpr int max_real_chars = 32;
+
+// Writes the shortest representation of a finite value that reads back as
+// the same value, the closest to it if there are several, always with a
+// fraction or exponent, and returns the end.
+REJSON_EXPORT char * format_real(double value, char * out);
+
+} }
+
+#endif
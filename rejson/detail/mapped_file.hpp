@@ -0,0 +1,54 @@
+#ifndef REJSON_DETAIL_MAPPED_FILE_HPP_
+#define REJSON_DETAIL_MAPPED_FILE_HPP_
+
+#include <rejson/export.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace rejson {
+
+// How the pages of a parsed file are going to be read, passed on to the
+// kernel as an madvise hint where files are mapped.
+enum class FileAccess : unsigned char {
+	Normal, Sequential, WillNeed
+};
+
+namespace detail {
+
+// Contents of a file followed by buffer_padding zero bytes, as the buffer
+// engine expects. Regular files are mapped read-only, and must not shrink
+// while mapped. Other files, such as pipes, are read whole into memory.
+class REJSON_EXPORT MappedFile
+{
+public:
+	MappedFile(const std::string & path, FileAccess access);
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	const char * begin() const;
+	const char * end() const;
+
+private:
+	const char * data_;
+	std::size_t size_;
+	std::size_t mapped_size_;
+	std::unique_ptr<char []> heap_;
+};
+
+inline const char * MappedFile::begin() const
+{
+	return data_;
+}
+
+inline const char * MappedFile::end() const
+{
+	return data_ + size_;
+}
+
+} }
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef REJSON_DETAIL_NUMBER_HPP_
+#define REJSON_DETAIL_NUMBER_HPP_
+
+#include <rejson/value.hpp>
+#include <rejson/detail/ctype.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+    || defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#	define rejson_little_endian 1
+#endif
+
+namespace rejson { namespace detail {
+
+// Exponents are saturated here while parsing; anything past it is already
+// far out of the range of a double.
+constexpr long long max_decimal_exponent = 100000000;
+
+// Powers of ten that are exactly representable as doubles.
+constexpr double exact_powers_of_ten[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+constexpr std::uint64_t max_exact_mantissa = std::uint64_t { 1 } << 53;
+
+#if rejson_little_endian
+
+// Whether the eight bytes at pos are all decimal digits.
+inline bool is_eight_digits(const char * pos)
+{
+	std::uint64_t chunk;
+	std::memcpy(&chunk, pos, sizeof(chunk));
+	return ((chunk & 0xf0f0f0f0f0f0f0f0)
+	        | (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4))
+	       == 0x3333333333333333;
+}
+
+// Converts eight digits at once: adjacent digits, then pairs, then
+// quadruples are merged with one multiplication each.
+inline std::uint32_t parse_eight_digits(const char * pos)
+{
+	std::uint64_t chunk;
+	std::memcpy(&chunk, pos, sizeof(chunk));
+	chunk = ((chunk & 0x0f0f0f0f0f0f0f0f) * 2561) >> 8;
+	chunk = ((chunk & 0x00ff00ff00ff00ff) * 6553601) >> 16;
+	return static_cast<std::uint32_t>(
+		((chunk & 0x0000ffff0000ffff) * 42949672960001) >> 32);
+}
+
+#endif
+
+// Appends the digits in [pos, end) to value. Overflow wraps around, so
+// callers must check the number of digits.
+inline std::uint64_t accumulate_digits(const char * pos, const char * end,
+                                       std::uint64_t value)
+{
+#if rejson_little_endian
+	for (; end - pos >= 8; pos += 8)
+		value = value * 100000000 + parse_eight_digits(pos);
+#endif
+	for (; pos != end; ++pos)
+		value = value * 10 + (*pos - '0');
+	return value;
+}
+
+// Skips a run of digits while appending them to value like
+// accumulate_digits(). It reads up to eight bytes ahead of the run, which
+// the buffer padding makes safe.
+inline const char * parse_digits(const char * pos, std::uint64_t & value)
+{
+#if rejson_little_endian
+	for (; is_eight_digits(pos); pos += 8)
+		value = value * 100000000 + parse_eight_digits(pos);
+#endif
+	for (; in_range(*pos, '0', '9'); ++pos)
+		value = value * 10 + (*pos - '0');
+	return pos;
+}
+
+// Stores the integer of the given sign and magnitude in value if it fits
+// in an Int. Magnitudes of more than 19 digits may have wrapped around.
+inline bool try_make_int(bool negative, std::uint64_t magnitude,
+                         std::size_t digits, Int & value)
+{
+	const auto limit = static_cast<std::uint64_t>(
+		std::numeric_limits<Int>::max()) + negative;
+	if (digits > 19 || magnitude > limit)
+		return false;
+	value = negative ? static_cast<Int>(0 - magnitude)
+	                 : static_cast<Int>(magnitude);
+	return true;
+}
+
+// Correctly rounded conversion for the cases the fast path cannot handle.
+// The digits are handed to strtod as "<digits>e<exponent>", which has no
+// decimal point and so does not depend on the current locale.
+inline Real parse_real_slow(const char * int_begin, const char * int_end,
+                            const char * frac_begin, const char * frac_end,
+                            long long exponent)
+{
+	std::string str;
+	str.reserve((int_end - int_begin) + (frac_end - frac_begin) + 24);
+	str.append(int_begin, int_end);
+	str.append(frac_begin, frac_end);
+	str += 'e';
+	str += std::to_string(exponent - (frac_end - frac_begin));
+	return std::strtod(str.c_str(), nullptr);
+}
+
+// Returns the double nearest to the number spelled by the integer digits,
+// the fraction digits and the decimal exponent. When the significand fits
+// in 53 bits and the power of ten is exact, a single multiplication or
+// division is correctly rounded (Clinger's fast path).
+inline Real make_real(const char * int_begin, const char * int_end,
+                      const char * frac_begin, const char * frac_end,
+                      long long exponent)
+{
+	const long long e = exponent - (frac_end - frac_begin);
+	// Leading zeros do not count towards the 19 digits that always fit.
+	const char * int_start = int_begin;
+	const char * frac_start = frac_begin;
+	while (int_start != int_end && *int_start == '0')
+		++int_start;
+	if (int_start == int_end) {
+		while (frac_start != frac_end && *frac_start == '0')
+			++frac_start;
+	}
+	const auto digits = (int_end - int_start) + (frac_end - frac_start);
+	if (digits == 0)
+		return 0.0;
+	const std::uint64_t mantissa = accumulate_digits(frac_start, frac_end,
+		accumulate_digits(int_start, int_end, 0));
+	if (digits <= 19 && mantissa <= max_exact_mantissa) {
+		const auto m = static_cast<Real>(mantissa);
+		if (e >= 0 && e <= 22)
+			return m * exact_powers_of_ten[e];
+		if (e < 0 && e >= -22)
+			return m / exact_powers_of_ten[-e];
+		// Move part of a large exponent into the significand when it
+		// still fits, as in "12e30".
+		if (e > 22 && e <= 22 + 15) {
+			const auto scaled = mantissa * static_cast<std::uint64_t>(
+				exact_powers_of_ten[e - 22]);
+			if (scaled / mantissa == static_cast<std::uint64_t>(
+			        exact_powers_of_ten[e - 22])
+			    && scaled <= max_exact_mantissa)
+				return static_cast<Real>(scaled) * exact_powers_of_ten[22];
+		}
+	}
+	return parse_real_slow(int_begin, int_end, frac_begin, frac_end, exponent);
+}
+
+} }
+
+#endif
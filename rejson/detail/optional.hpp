@@ -2,7 +2,7 @@
 #define REJSON_DETAIL_OPTIONAL_HPP_
 
 #ifdef __has_include
-#	if __has_include(<optional>)
+#	if __has_include(<optional>) && __cplusplus >= 201703L
 #		define rejson_have_std_optional 1
 #		include <optional>
 #	elif __has_include(<experimental/optional>)
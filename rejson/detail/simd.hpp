@@ -0,0 +1,237 @@
+#ifndef REJSON_DETAIL_SIMD_HPP_
+#define REJSON_DETAIL_SIMD_HPP_
+
+#include <rejson/detail/ctype.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#	define rejson_have_avx2 1
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#	define rejson_have_sse2 1
+#	include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+// Block scanners used by the buffer engine. They may read up to 32 bytes
+// past the returned position, which the buffer padding makes safe.
+
+namespace rejson { namespace detail {
+
+inline unsigned count_trailing_zeros(std::uint32_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+inline unsigned count_trailing_zeros(std::uint64_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+// Bits set for the bytes of a 64-byte block in each class, where op is for
+// the structural characters {}[]:,.
+struct BlockMasks
+{
+	std::uint64_t quote;
+	std::uint64_t backslash;
+	std::uint64_t space;
+	std::uint64_t op;
+};
+
+#if rejson_have_avx2
+
+inline std::uint32_t string_delimiter_mask(const char * pos)
+{
+	const auto chunk = _mm256_loadu_si256(
+		reinterpret_cast<const __m256i *>(pos));
+	const auto quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+	const auto bslash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+	const auto ctrl = _mm256_cmpeq_epi8(
+		_mm256_subs_epu8(chunk, _mm256_set1_epi8(0x1f)),
+		_mm256_setzero_si256());
+	return _mm256_movemask_epi8(
+		_mm256_or_si256(_mm256_or_si256(quote, bslash), ctrl));
+}
+
+inline std::uint32_t space_mask(const char * pos)
+{
+	const auto chunk = _mm256_loadu_si256(
+		reinterpret_cast<const __m256i *>(pos));
+	const auto sp = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '));
+	const auto ht = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'));
+	const auto lf = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'));
+	const auto cr = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'));
+	return _mm256_movemask_epi8(
+		_mm256_or_si256(_mm256_or_si256(sp, ht), _mm256_or_si256(lf, cr)));
+}
+
+inline std::uint32_t non_ascii_mask(const char * pos)
+{
+	return _mm256_movemask_epi8(_mm256_loadu_si256(
+		reinterpret_cast<const __m256i *>(pos)));
+}
+
+inline void classify_chunk(const char * pos, std::uint32_t (&masks)[4])
+{
+	const auto chunk = _mm256_loadu_si256(
+		reinterpret_cast<const __m256i *>(pos));
+	const auto is = [chunk] (char chr) {
+		return _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(chr));
+	};
+	masks[0] = _mm256_movemask_epi8(is('"'));
+	masks[1] = _mm256_movemask_epi8(is('\\'));
+	masks[2] = space_mask(pos);
+	masks[3] = _mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_or_si256(_mm256_or_si256(is('{'), is('}')),
+		                _mm256_or_si256(is('['), is(']'))),
+		_mm256_or_si256(is(':'), is(','))));
+}
+
+constexpr unsigned simd_block_size = 32;
+
+#elif rejson_have_sse2
+
+inline std::uint32_t string_delimiter_mask(const char * pos)
+{
+	const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+	const auto quote = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+	const auto bslash = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+	const auto ctrl = _mm_cmpeq_epi8(
+		_mm_subs_epu8(chunk, _mm_set1_epi8(0x1f)), _mm_setzero_si128());
+	return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(quote, bslash), ctrl));
+}
+
+inline std::uint32_t space_mask(const char * pos)
+{
+	const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+	const auto sp = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+	const auto ht = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'));
+	const auto lf = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+	const auto cr = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'));
+	return _mm_movemask_epi8(
+		_mm_or_si128(_mm_or_si128(sp, ht), _mm_or_si128(lf, cr)));
+}
+
+inline std::uint32_t non_ascii_mask(const char * pos)
+{
+	return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos)));
+}
+
+inline void classify_chunk(const char * pos, std::uint32_t (&masks)[4])
+{
+	const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+	const auto is = [chunk] (char chr) {
+		return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(chr));
+	};
+	masks[0] = _mm_movemask_epi8(is('"'));
+	masks[1] = _mm_movemask_epi8(is('\\'));
+	masks[2] = space_mask(pos);
+	masks[3] = _mm_movemask_epi8(_mm_or_si128(
+		_mm_or_si128(_mm_or_si128(is('{'), is('}')),
+		             _mm_or_si128(is('['), is(']'))),
+		_mm_or_si128(is(':'), is(','))));
+}
+
+constexpr unsigned simd_block_size = 16;
+
+#endif
+
+// Returns the first '"', '\\' or control character at or after pos.
+inline const char * find_string_delimiter(const char * pos)
+{
+#if rejson_have_avx2 || rejson_have_sse2
+	for (;; pos += simd_block_size) {
+		if (const auto mask = string_delimiter_mask(pos))
+			return pos + count_trailing_zeros(mask);
+	}
+#else
+	while (!is_string_delimiter(*pos))
+		++pos;
+	return pos;
+#endif
+}
+
+// Returns the first '"', '\\' or control character in [pos, end), or end.
+// Unlike the unbounded scanners it never reads past end.
+inline const char * find_string_delimiter(const char * pos, const char * end)
+{
+#if rejson_have_avx2 || rejson_have_sse2
+	for (; std::size_t(end - pos) >= simd_block_size; pos += simd_block_size) {
+		if (const auto mask = string_delimiter_mask(pos))
+			return pos + count_trailing_zeros(mask);
+	}
+#endif
+	while (pos != end && !is_string_delimiter(*pos))
+		++pos;
+	return pos;
+}
+
+// Returns the first non-whitespace character at or after pos.
+inline const char * skip_spaces(const char * pos)
+{
+	if (!is_space(*pos))
+		return pos;
+#if rejson_have_avx2 || rejson_have_sse2
+	constexpr std::uint32_t full_mask = (1ull << simd_block_size) - 1;
+	for (;; pos += simd_block_size) {
+		if (const auto mask = ~space_mask(pos) & full_mask)
+			return pos + count_trailing_zeros(mask);
+	}
+#else
+	while (is_space(*pos))
+		++pos;
+	return pos;
+#endif
+}
+
+// Classifies the 64 bytes at pos, which may all lie in the padding.
+inline BlockMasks classify_block(const char * pos)
+{
+	BlockMasks block {};
+#if rejson_have_avx2 || rejson_have_sse2
+	for (unsigned offset = 0; offset < 64; offset += simd_block_size) {
+		std::uint32_t masks[4];
+		classify_chunk(pos + offset, masks);
+		block.quote |= std::uint64_t(masks[0]) << offset;
+		block.backslash |= std::uint64_t(masks[1]) << offset;
+		block.space |= std::uint64_t(masks[2]) << offset;
+		block.op |= std::uint64_t(masks[3]) << offset;
+	}
+#else
+	for (unsigned offset = 0; offset < 64; ++offset) {
+		const auto bit = std::uint64_t(1) << offset;
+		switch (pos[offset]) {
+		case '"': block.quote |= bit; break;
+		case '\\': block.backslash |= bit; break;
+		case '{': case '}': case '[': case ']': case ':': case ',':
+			block.op |= bit;
+			break;
+		default:
+			if (is_space(pos[offset]))
+				block.space |= bit;
+		}
+	}
+#endif
+	return block;
+}
+
+} }
+
+#endif
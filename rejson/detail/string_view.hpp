@@ -2,7 +2,7 @@
 #define REJSON_DETAIL_STRING_VIEW_HPP_
 
 #ifdef __has_include
-#	if __has_include(<string_view>)
+#	if __has_include(<string_view>) && __cplusplus >= 201703L
 #		define rejson_have_std_string_view 1
 #		include <string_view>
 #	elif __has_include(<experimental/string_view>)
@@ -0,0 +1,256 @@
+#ifndef REJSON_DETAIL_STRUCTURAL_HPP_
+#define REJSON_DETAIL_STRUCTURAL_HPP_
+
+#include <rejson/error.hpp>
+#include <rejson/detail/buffer.hpp>
+#include <rejson/detail/simd.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace rejson { namespace detail {
+
+// Offsets of the structural characters {}[]:, of a padded buffer outside
+// strings, and of the first byte of every other value: opening quotes,
+// numbers and literals. Found 64 bytes at a time, with strings and escapes
+// tracked as bit masks rather than byte by byte.
+class StructuralIndex
+{
+public:
+	explicit StructuralIndex(const PaddedBuffer & buffer);
+
+	const std::uint32_t * begin() const;
+	const std::uint32_t * end() const;
+	std::size_t size() const;
+
+private:
+	static std::uint64_t prefix_xor(std::uint64_t bits);
+	static std::uint64_t escaped_bits(std::uint64_t backslash,
+	                                  std::uint64_t & carry);
+
+	std::unique_ptr<std::uint32_t []> offsets_;
+	std::size_t size_;
+};
+
+inline StructuralIndex::StructuralIndex(const PaddedBuffer & buffer)
+	: size_ { 0 }
+{
+	const char * const data = buffer.begin();
+	const std::size_t size = buffer.end() - data;
+	if (size > std::numeric_limits<std::uint32_t>::max())
+		throw ParseError("input too large");
+	// Left uninitialized, so that only the pages used are touched.
+	std::size_t capacity = size / 4 + 64;
+	offsets_.reset(new std::uint32_t[capacity]);
+	std::uint64_t escape_carry = 0, string_carry = 0, scalar_carry = 0;
+	for (std::size_t base = 0; base < size; base += 64) {
+		const auto block = classify_block(data + base);
+		const auto quote = block.quote & ~escaped_bits(block.backslash, escape_carry);
+		// Set from each opening quote up to the closing one, excluded.
+		const auto in_string = prefix_xor(quote) ^ string_carry;
+		string_carry = std::uint64_t(std::int64_t(in_string) >> 63);
+		const auto string_tail = in_string ^ quote;
+		// Values other than strings start after whitespace or a structural
+		// character, and so do the quotes opening strings.
+		const auto scalar = ~(block.op | block.space);
+		const auto follows_scalar = (scalar & ~quote) << 1 | scalar_carry;
+		scalar_carry = (scalar & ~quote) >> 63;
+		auto bits = (block.op | (scalar & ~follows_scalar)) & ~string_tail;
+		if (size - base < 64)
+			bits &= (std::uint64_t(1) << (size - base)) - 1;
+		if (capacity - size_ < 64) {
+			std::unique_ptr<std::uint32_t []> grown { new std::uint32_t[capacity * 2] };
+			std::memcpy(grown.get(), offsets_.get(), size_ * sizeof(std::uint32_t));
+			offsets_ = std::move(grown);
+			capacity *= 2;
+		}
+		auto out = offsets_.get() + size_;
+		for (; bits; bits &= bits - 1)
+			*out++ = std::uint32_t(base + count_trailing_zeros(bits));
+		size_ = out - offsets_.get();
+	}
+}
+
+inline const std::uint32_t * StructuralIndex::begin() const
+{
+	return offsets_.get();
+}
+
+inline const std::uint32_t * StructuralIndex::end() const
+{
+	return offsets_.get() + size_;
+}
+
+inline std::size_t StructuralIndex::size() const
+{
+	return size_;
+}
+
+// Bit i of the result is the parity of bits 0 to i.
+inline std::uint64_t StructuralIndex::prefix_xor(std::uint64_t bits)
+{
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+// Bits of the characters following an odd run of backslashes, which are
+// escaped. The carry tells whether the previous block ended such a run.
+inline std::uint64_t StructuralIndex::escaped_bits(std::uint64_t backslash,
+                                                   std::uint64_t & carry)
+{
+	constexpr std::uint64_t even_bits = 0x5555555555555555;
+	constexpr std::uint64_t odd_bits = ~even_bits;
+	const auto starts = backslash & ~(backslash << 1);
+	const auto even_start_mask = even_bits ^ carry;
+	const auto even_starts = starts & even_start_mask;
+	const auto odd_starts = starts & ~even_start_mask;
+	const auto even_carries = backslash + even_starts;
+	auto odd_carries = backslash + odd_starts;
+	const bool ends_odd = odd_carries < backslash;
+	odd_carries |= carry;
+	carry = ends_odd;
+	const auto even_carry_ends = even_carries & ~backslash;
+	const auto odd_carry_ends = odd_carries & ~backslash;
+	return (even_carry_ends & odd_bits) | (odd_carry_ends & even_bits);
+}
+
+// Second stage: the grammar of the buffer engine walked over the tokens of
+// the index, jumping over whitespace and string contents. Scalars are still
+// read by the buffer engine.
+namespace indexed {
+
+using Token = const std::uint32_t *;
+
+template <class Handler>
+const char * parse_value(const char * data, const char * end, Token & token,
+                         Token last, Handler & handler);
+
+// Returns the character of the next token, which must follow pos after
+// whitespace only.
+inline char next_token(const char * data, const char * end, const char * pos,
+                       Token token, Token last, const char * what)
+{
+	pos = skip_spaces(pos);
+	if (token == last || data + *token != pos)
+		buffer::fail(pos, end, what);
+	return *pos;
+}
+
+// Checks the token following a separator or an opening bracket. Nothing
+// else than whitespace can come before it, as anything else would be a
+// token itself.
+inline char separated_token(const char * data, Token token, Token last)
+{
+	if (token == last)
+		throw ParseError("unexpected end of input");
+	return data[*token];
+}
+
+template <class Handler>
+const char * parse_array(const char * data, const char * end, Token & token,
+                         Token last, Handler & handler)
+{
+	std::size_t size = 0;
+	handler.on_array_begin();
+	if (separated_token(data, ++token, last) == ']') {
+		handler.on_array_end(size);
+		return data + *token++ + 1;
+	}
+	for (;;) {
+		const char * const pos = parse_value(data, end, token, last, handler);
+		++size;
+		switch (next_token(data, end, pos, token, last, "expected ',' or ']' token")) {
+		case ',':
+			switch (separated_token(data, ++token, last)) {
+			case ',':
+			case ']':
+				throw ParseError("unexpected ',' token");
+			}
+			break;
+		case ']':
+			handler.on_array_end(size);
+			return data + *token++ + 1;
+		default:
+			throw ParseError("expected ',' or ']' token");
+		}
+	}
+}
+
+template <class Handler>
+const char * parse_object(const char * data, const char * end, Token & token,
+                          Token last, Handler & handler)
+{
+	std::size_t size = 0;
+	std::string scratch;
+	handler.on_object_begin();
+	if (separated_token(data, ++token, last) == '}') {
+		handler.on_object_end(size);
+		return data + *token++ + 1;
+	}
+	for (;;) {
+		const char * pos = data + *token++;
+		handler.on_key(buffer::parse_string(pos, end, scratch));
+		if (next_token(data, end, pos, token, last, "expected ':' token") != ':')
+			throw ParseError("expected ':' token");
+		separated_token(data, ++token, last);
+		pos = parse_value(data, end, token, last, handler);
+		++size;
+		switch (next_token(data, end, pos, token, last, "expected ',' or '}' token")) {
+		case ',':
+			switch (separated_token(data, ++token, last)) {
+			case ',':
+			case '}':
+				throw ParseError("unexpected ',' token");
+			}
+			break;
+		case '}':
+			handler.on_object_end(size);
+			return data + *token++ + 1;
+		default:
+			throw ParseError("expected ',' or '}' token");
+		}
+	}
+}
+
+// Parses the value starting at the current token, which must exist, and
+// returns the end of its text, with token moved past its tokens.
+template <class Handler>
+const char * parse_value(const char * data, const char * end, Token & token,
+                         Token last, Handler & handler)
+{
+	const char * pos = data + *token;
+	switch (*pos) {
+	case '[': return parse_array(data, end, token, last, handler);
+	case '{': return parse_object(data, end, token, last, handler);
+	default:
+		++token;
+		buffer::parse_value(pos, end, handler);
+		return pos;
+	}
+}
+
+template <class Handler>
+void parse(const PaddedBuffer & buffer, Handler & handler)
+{
+	const StructuralIndex index { buffer };
+	Token token = index.begin();
+	if (token == index.end())
+		throw ParseError("unexpected end of input");
+	parse_value(buffer.begin(), buffer.end(), token, index.end(), handler);
+}
+
+}
+
+} }
+
+#endif
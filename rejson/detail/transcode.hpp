@@ -0,0 +1,45 @@
+#ifndef REJSON_DETAIL_TRANSCODE_HPP_
+#define REJSON_DETAIL_TRANSCODE_HPP_
+
+#include <rejson/export.h>
+#include <rejson/detail/string_view.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace rejson { namespace detail {
+
+// Wide input transcoded to UTF-8 and padded for the buffer engine. Runs of
+// ASCII are narrowed a block at a time. Unpaired UTF-16 surrogates and
+// UTF-32 code units outside the Unicode scalar values throw ParseError.
+class REJSON_EXPORT TranscodedBuffer
+{
+public:
+	explicit TranscodedBuffer(u16string_view sv);
+	explicit TranscodedBuffer(u32string_view sv);
+	explicit TranscodedBuffer(wstring_view sv);
+
+	TranscodedBuffer(const TranscodedBuffer &) = delete;
+	TranscodedBuffer & operator=(const TranscodedBuffer &) = delete;
+
+	const char * begin() const;
+	const char * end() const;
+
+private:
+	std::unique_ptr<char []> data_;
+	std::size_t size_;
+};
+
+inline const char * TranscodedBuffer::begin() const
+{
+	return data_.get();
+}
+
+inline const char * TranscodedBuffer::end() const
+{
+	return data_.get() + size_;
+}
+
+} }
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef REJSON_DETAIL_UTF8_HPP_
+#define REJSON_DETAIL_UTF8_HPP_
+
+namespace rejson { namespace detail {
+
+inline char * encode_utf8(char32_t code_pt, char * out)
+{
+	if (code_pt < 0x80) {
+		*out++ = code_pt;
+	} else if (code_pt < 0x800) {
+		*out++ = (code_pt >> 6) | 0xc0;
+		*out++ = (code_pt & 0x3f) | 0x80;
+	} else if (code_pt < 0x10000) {
+		*out++ = (code_pt >> 12) | 0xe0;
+		*out++ = ((code_pt >> 6) & 0x3f) | 0x80;
+		*out++ = (code_pt & 0x3f) | 0x80;
+	} else {
+		*out++ = (code_pt >> 18) | 0xf0;
+		*out++ = ((code_pt >> 12) & 0x3f) | 0x80;
+		*out++ = ((code_pt >> 6) & 0x3f) | 0x80;
+		*out++ = (code_pt & 0x3f) | 0x80;
+	}
+	return out;
+}
+
+template <class Str>
+void append_utf8(char32_t code_pt, Str & str)
+{
+	char buffer[4];
+	str.append(buffer, encode_utf8(code_pt, buffer));
+}
+
+} }
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef REJSON_DOCUMENT_HPP_
+#define REJSON_DOCUMENT_HPP_
+
+#include <rejson/arena.hpp>
+#include <rejson/value.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <memory>
+
+namespace rejson {
+
+class REJSON_EXPORT Document
+{
+public:
+	Document();
+	Document(Document && other) noexcept;
+	~Document();
+
+	Document & operator=(Document && other) noexcept;
+
+	const Value & root() const;
+
+private:
+	friend REJSON_EXPORT Document parse_document(detail::string_view sv);
+
+	std::unique_ptr<Arena> arena_;
+	const Value * root_;
+};
+
+REJSON_EXPORT Document parse_document(detail::string_view sv);
+
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef REJSON_DUMP_HPP_
+#define REJSON_DUMP_HPP_
+
+#include <rejson/export.h>
+#include <rejson/value.hpp>
+
+#include <ostream>
+#include <string>
+
+namespace rejson {
+
+// Serializes a value as JSON. With a zero indent the output is compact;
+// otherwise nested values go on their own lines, indented by that many
+// spaces per level. Non-finite reals are written as null.
+REJSON_EXPORT std::string dump(const Value & value, unsigned indent = 0);
+
+// Same, but appends to out.
+REJSON_EXPORT void dump(const Value & value, std::string & out,
+                        unsigned indent = 0);
+
+// Same, but writes to os through a small intermediate buffer.
+REJSON_EXPORT void write(const Value & value, std::ostream & os,
+                         unsigned indent = 0);
+
+}
+
+#endif
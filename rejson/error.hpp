@@ -0,0 +1,17 @@
+#ifndef REJSON_ERROR_HPP_
+#define REJSON_ERROR_HPP_
+
+#include <rejson/export.h>
+
+#include <stdexcept>
+
+namespace rejson {
+
+class REJSON_EXPORT ParseError : public std::runtime_error
+{
+	using runtime_error::runtime_error;
+};
+
+}
+
+#endif
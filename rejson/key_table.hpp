@@ -0,0 +1,51 @@
+#ifndef REJSON_KEY_TABLE_HPP_
+#define REJSON_KEY_TABLE_HPP_
+
+#include <rejson/arena.hpp>
+#include <rejson/export.h>
+#include <rejson/string.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace rejson {
+
+// Object keys shared by every document parsed with the table. Each distinct
+// key is stored once next to its hash, and the strings handed out refer to
+// that copy, so keys of one table compare by address and are never hashed
+// again. The table must outlive the values holding its keys. Interning is
+// safe from several threads at once.
+class REJSON_EXPORT KeyTable
+{
+public:
+	KeyTable();
+	~KeyTable();
+
+	KeyTable(const KeyTable &) = delete;
+	KeyTable & operator=(const KeyTable &) = delete;
+
+	String intern(detail::string_view key);
+
+	std::size_t size() const;
+
+private:
+	struct KeyHash
+	{
+		std::size_t operator()(detail::string_view key) const noexcept
+		{
+			return detail::hash_bytes(key.data(), key.size());
+		}
+	};
+
+	std::uint16_t id_;
+	mutable std::shared_timed_mutex mutex_;
+	Arena arena_;
+	std::unordered_map<detail::string_view, String, KeyHash> keys_;
+};
+
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef REJSON_NDJSON_HPP_
+#define REJSON_NDJSON_HPP_
+
+#include <rejson/export.h>
+#include <rejson/value.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace rejson {
+
+// Parses newline-delimited JSON, one value per line. Blank lines are
+// skipped. Every newline ends a record, including one inside a string,
+// which leaves both lines invalid. Records are parsed in parallel on the
+// given number of threads, or one per core if zero.
+REJSON_EXPORT std::vector<Value> parse_ndjson(detail::string_view sv,
+                                              unsigned threads = 0);
+
+// Same, but hands values to the callback on the calling thread, in input
+// order, as soon as all records before them have been parsed.
+REJSON_EXPORT void parse_ndjson(detail::string_view sv,
+                                const std::function<void (Value)> & callback,
+                                unsigned threads = 0);
+
+}
+
+#endif
@@ -1,42 +1,195 @@
 #ifndef REJSON_PARSE_HPP_
 #define REJSON_PARSE_HPP_
 
+#include <rejson/error.hpp>
+#include <rejson/key_table.hpp>
+#include <rejson/utf8.hpp>
 #include <rejson/value.hpp>
+#include <rejson/detail/buffer.hpp>
+#include <rejson/detail/ctype.hpp>
+#include <rejson/detail/mapped_file.hpp>
+#include <rejson/detail/number.hpp>
+#include <rejson/detail/structural.hpp>
 #include <rejson/detail/string_view.hpp>
+#include <rejson/detail/utf8.hpp>
 
 #include <algorithm>
 #include <cctype>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
-#include <cmath>
 #include <istream>
 #include <iterator>
-#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace rejson {
 
-class REJSON_EXPORT ParseError : public std::runtime_error
-{
-	using runtime_error::runtime_error;
-};
-
 REJSON_EXPORT Value parse(detail::string_view sv);
 REJSON_EXPORT Value parse(detail::wstring_view sv);
 REJSON_EXPORT Value parse(detail::u16string_view sv);
 REJSON_EXPORT Value parse(detail::u32string_view sv);
 
+REJSON_EXPORT const Value & parse(detail::string_view sv, Arena & arena);
+
+// Checks applied to the bytes of strings and object keys, which parse
+// otherwise takes as they are.
+enum class Utf8Check : unsigned char {
+	None, Strict
+};
+
+REJSON_EXPORT Value parse(detail::string_view sv, Utf8Check check);
+
+// Same as above, with object keys interned in the given table.
+REJSON_EXPORT Value parse(detail::string_view sv, KeyTable & keys);
+REJSON_EXPORT const Value & parse(detail::string_view sv, Arena & arena,
+                                  KeyTable & keys);
+
+// Parses the file at path. Regular files are mapped rather than read, and
+// must not be truncated while parsed; the access hint applies to them.
+REJSON_EXPORT Value parse_file(const std::string & path,
+                               FileAccess access = FileAccess::Sequential);
+REJSON_EXPORT const Value & parse_file(const std::string & path, Arena & arena,
+                                       FileAccess access = FileAccess::Sequential);
+
+template <class Handler>
+void parse_file(const std::string & path, Handler & handler,
+                FileAccess access = FileAccess::Sequential);
+
 template <class Iterator>
 Value parse(Iterator begin, Iterator end);
 
+// Reads the stream buffer directly, a block at a time, and leaves what
+// follows the value in the stream. Only what the stream buffer holds is
+// read at once, so values arriving through a pipe are returned as soon as
+// they are complete, except that a top-level number needs the character
+// after it. Stream buffers that show no get area, such as std::cin while it
+// is synchronized with stdio, are read a character at a time, which is much
+// slower. Characters read past the value are put back, and the stream gets
+// failbit if its buffer refuses them. Wide streams are read to their end.
 template <typename Char>
 Value parse(std::basic_istream<Char> & is);
 
+template <class Handler>
+void parse(detail::string_view sv, Handler & handler);
+
+template <class Iterator, class Handler>
+void parse(Iterator begin, Iterator end, Handler & handler);
+
+// Same as above, in two passes: the first finds every token of the input
+// 64 bytes at a time, and the second walks the tokens, never going over
+// whitespace or the inside of strings byte by byte.
+template <class Handler>
+void parse_indexed(detail::string_view sv, Handler & handler);
+
+class ValueBuilder
+{
+public:
+	explicit ValueBuilder(const Allocator<char> & alloc = {},
+	                      KeyTable * key_table = nullptr);
+
+	void on_null();
+	void on_bool(Bool b);
+	void on_int(Int i);
+	void on_real(Real r);
+	void on_string(detail::string_view s);
+	void on_key(detail::string_view k);
+	void on_array_begin();
+	void on_array_end(std::size_t size);
+	void on_object_begin();
+	void on_object_end(std::size_t size);
+
+	Value take();
+	void clear();
+
+private:
+	Allocator<char> alloc_;
+	KeyTable * key_table_;
+	std::vector<Value> values_;
+	std::vector<String> keys_;
+};
+
+inline ValueBuilder::ValueBuilder(const Allocator<char> & alloc,
+                                  KeyTable * key_table)
+	: alloc_ { alloc }, key_table_ { key_table } {}
+
+inline void ValueBuilder::on_null()
+{
+	values_.emplace_back(nullptr);
+}
+
+inline void ValueBuilder::on_bool(Bool b)
+{
+	values_.emplace_back(b);
+}
+
+inline void ValueBuilder::on_int(Int i)
+{
+	values_.emplace_back(i);
+}
+
+inline void ValueBuilder::on_real(Real r)
+{
+	values_.emplace_back(r);
+}
+
+inline void ValueBuilder::on_string(detail::string_view s)
+{
+	values_.emplace_back(String(s.data(), s.size(), alloc_));
+}
+
+inline void ValueBuilder::on_key(detail::string_view k)
+{
+	if (key_table_)
+		keys_.push_back(key_table_->intern(k));
+	else
+		keys_.emplace_back(k.data(), k.size(), alloc_);
+}
+
+inline void ValueBuilder::on_array_begin() {}
+
+inline void ValueBuilder::on_array_end(std::size_t size)
+{
+	const auto first = values_.end() - size;
+	Array array(std::make_move_iterator(first),
+	            std::make_move_iterator(values_.end()), alloc_);
+	values_.erase(first, values_.end());
+	values_.emplace_back(std::move(array));
+}
+
+inline void ValueBuilder::on_object_begin() {}
+
+inline void ValueBuilder::on_object_end(std::size_t size)
+{
+	const auto first_value = values_.end() - size;
+	const auto first_key = keys_.end() - size;
+	Object object(alloc_, size);
+	for (std::size_t i = 0; i < size; ++i)
+		object.emplace(std::move(first_key[i]), std::move(first_value[i]));
+	values_.erase(first_value, values_.end());
+	keys_.erase(first_key, keys_.end());
+	values_.emplace_back(std::move(object));
+}
+
+inline Value ValueBuilder::take()
+{
+	Value value = std::move(values_.back());
+	values_.pop_back();
+	return value;
+}
+
+inline void ValueBuilder::clear()
+{
+	values_.clear();
+	keys_.clear();
+}
+
 namespace detail {
 
-template <class Iterator>
-Value parse_value(Iterator & begin, Iterator end);
+template <class Iterator, class Handler>
+void parse_value(Iterator & begin, Iterator end, Handler & handler);
 
 template <class Iterator>
 using char_type = typename std::iterator_traits<Iterator>::value_type;
@@ -101,7 +254,7 @@ template <class Iterator>
 void skip_whitespace(Iterator & begin, Iterator end)
 {
 	for (; begin != end; ++begin) {
-		if (!std::isspace(*begin))
+		if (!is_space(*begin))
 			break;
 	}
 }
@@ -169,18 +322,6 @@ bool try_parse_codept(Iterator & begin, Iterator end, char16_t & code_pt)
 	return true;
 }
 
-template <typename T, typename Min, typename Max>
-constexpr bool in_range(T x, Min min, Max max)
-{
-	return x >= min && x <= max;
-}
-
-constexpr bool is_codept_group(char16_t first, char16_t second)
-{
-	return in_range(first, 0xd800, 0xdbff)
-	    && in_range(second, 0xdc00, 0xdfff);
-}
-
 template <class Iterator>
 char_type<Iterator> parse_escaped(Iterator & begin, Iterator end)
 {
@@ -196,77 +337,82 @@ char_type<Iterator> parse_escaped(Iterator & begin, Iterator end)
 	}
 }
 
-inline void encode_utf8(char32_t code_pt, std::ostringstream & os)
+inline void flush_surrogate(char16_t & high_pt, String & str)
 {
-	if (code_pt < 0x80) {
-		os.put(code_pt & 0xff);
-	} else if (code_pt < 0x8000) {
-		os.put((code_pt >> 6) | 0xc0);
-		os.put((code_pt & 0x3f) | 0x80);
-	} else if (code_pt < 0x1000) {
-		os.put((code_pt >> 12) | 0xe0);
-		os.put(((code_pt >> 6) & 0x3f) | 0x80);
-		os.put((code_pt & 0x3f) | 0x80);
-	} else {
-		os.put((code_pt >> 18) | 0xf0);
-		os.put(((code_pt >> 12) & 0x3f) | 0x80);
-		os.put(((code_pt >> 6) & 0x3f) | 0x80);
-		os.put((code_pt & 0x3f) | 0x80);
-	}
+	if (high_pt != 0)
+		append_utf8(high_pt, str);
+	high_pt = 0;
+}
+
+template <class Iterator>
+void append_unescaped(Iterator & begin, Iterator end, String & str,
+                      std::input_iterator_tag)
+{
+	for (; begin != end && !is_string_delimiter(*begin); ++begin)
+		str += *begin;
+}
+
+template <class Iterator>
+void append_unescaped(Iterator & begin, Iterator end, String & str,
+                      std::forward_iterator_tag)
+{
+	const Iterator run = begin;
+	while (begin != end && !is_string_delimiter(*begin))
+		++begin;
+	str.append(run, begin);
+}
+
+template <class Iterator>
+void append_unescaped(Iterator & begin, Iterator end, String & str)
+{
+	using category = typename std::iterator_traits<Iterator>::iterator_category;
+	append_unescaped(begin, end, str, category());
 }
 
 template <class Iterator>
 String parse_string(Iterator & begin, Iterator end)
 {
-	long last_code_pt = -1;
-	std::ostringstream oss;
+	String str;
+	char16_t high_pt = 0;
 	consume(begin, end, '"');
-	while (begin != end) {
-		switch (const auto chr = *begin) {
+	for (;;) {
+		switch (const auto chr = peek_char(begin, end)) {
 		case '"':
-			if (last_code_pt != -1)
-				encode_utf8(last_code_pt, oss);
-			return ++begin, oss.str();
+			flush_surrogate(high_pt, str);
+			return ++begin, std::move(str);
 		case '\\': {
 			char16_t code_pt;
-			if (try_parse_codept(begin, end, code_pt)) {
-				if (is_codept_group(last_code_pt, code_pt)) {
-					const auto hi = last_code_pt - 0xd800;
-					const auto lo = code_pt - 0xdc00 + 0x10000;
-					encode_utf8(hi << 10 | lo, oss);
-					last_code_pt = -1;
-				} else {
-					if (last_code_pt != -1)
-						encode_utf8(last_code_pt, oss);
-					last_code_pt = code_pt;
-				}
+			if (!try_parse_codept(begin, end, code_pt)) {
+				flush_surrogate(high_pt, str);
+				str += parse_escaped(begin, end);
+			} else if (high_pt != 0 && in_range(code_pt, U'\xdc00', U'\xdfff')) {
+				append_utf8(0x10000 + ((high_pt - 0xd800) << 10)
+				                    + (code_pt - 0xdc00), str);
+				high_pt = 0;
 			} else {
-				const auto esc = parse_escaped(begin, end);
-				if (last_code_pt != -1)
-					encode_utf8(last_code_pt, oss);
-				last_code_pt = -1;
-				oss.put(esc);
+				flush_surrogate(high_pt, str);
+				if (in_range(code_pt, U'\xd800', U'\xdbff'))
+					high_pt = code_pt;
+				else
+					append_utf8(code_pt, str);
 			}
 			break;
 		}
 		default:
-			if (last_code_pt != -1)
-				encode_utf8(last_code_pt, oss);
-			last_code_pt = -1;
-			if (std::iscntrl(chr))
+			if (is_control(chr))
 				throw ParseError("unescaped data in string");
-			oss.put(chr);
-			++begin;
+			flush_surrogate(high_pt, str);
+			append_unescaped(begin, end, str);
 		}
 	}
-	throw ParseError("unexpected end of input");
 }
 
-template <class Iterator>
-Array parse_array(Iterator & begin, Iterator end)
+template <class Iterator, class Handler>
+void parse_array(Iterator & begin, Iterator end, Handler & handler)
 {
-	Array array;
+	std::size_t size = 0;
 	consume(begin, end, '[');
+	handler.on_array_begin();
 	char_type<Iterator> last_token = '[';
 	while (begin != end) {
 		skip_whitespace(begin, end);
@@ -279,33 +425,36 @@ Array parse_array(Iterator & begin, Iterator end)
 		case ']':
 			if (last_token == ',')
 				throw ParseError("unexpected ',' token");
-			return ++begin, array;
+			++begin;
+			handler.on_array_end(size);
+			return;
 		default:
 			if (last_token != '[' && last_token != ',')
 				throw ParseError("expected ',' or ']' token");
-			array.emplace_back(parse_value(begin, end));
+			parse_value(begin, end, handler);
+			++size;
 		}
 		last_token = chr;
 	}
 	throw ParseError("unexpected end of input");
 }
 
-template <class Iterator>
-KeyValuePair parse_pair(Iterator & begin, Iterator end)
+template <class Iterator, class Handler>
+void parse_pair(Iterator & begin, Iterator end, Handler & handler)
 {
-	const auto key = parse_string(begin, end);
+	handler.on_key(parse_string(begin, end));
 	skip_whitespace(begin, end);
 	consume(begin, end, ':');
 	skip_whitespace(begin, end);
-	const auto value = parse_value(begin, end);
-	return std::make_pair(std::move(key), std::move(value));
+	parse_value(begin, end, handler);
 }
 
-template <class Iterator>
-Object parse_object(Iterator & begin, Iterator end)
+template <class Iterator, class Handler>
+void parse_object(Iterator & begin, Iterator end, Handler & handler)
 {
-	Object object;
+	std::size_t size = 0;
 	consume(begin, end, '{');
+	handler.on_object_begin();
 	char_type<Iterator> last_token = '{';
 	while (begin != end) {
 		skip_whitespace(begin, end);
@@ -318,11 +467,14 @@ Object parse_object(Iterator & begin, Iterator end)
 		case '}':
 			if (last_token == ',')
 				throw ParseError("unexpected ',' token");
-			return ++begin, object;
+			++begin;
+			handler.on_object_end(size);
+			return;
 		default:
 			if (last_token != '{' && last_token != ',')
 				throw ParseError("expected ',' or '}' token");
-			object.emplace(parse_pair(begin, end));
+			parse_pair(begin, end, handler);
+			++size;
 		}
 		last_token = chr;
 	}
@@ -341,57 +493,41 @@ Sign parse_sign_or(Iterator & begin, Iterator end, Sign defvalue)
 	return defvalue;
 }
 
-template <class Iterator, typename Num>
-bool try_parse_num(Iterator & begin, Iterator end, Num & num)
+template <class Iterator>
+bool try_parse_digits(Iterator & begin, Iterator end, std::string & digits)
 {
-	Num result = 0;
-	Iterator try_iter;
-	for (try_iter = begin; try_iter != end; ++try_iter) {
-		const auto chr = *try_iter;
-		if (!std::isdigit(chr))
-			break;
-		result *= 10;
-		result += chr - '0';
-	}
-	if (try_iter == begin)
-		return false;
-	begin = try_iter;
-	num = result;
-	return true;
+	const auto size = digits.size();
+	for (; begin != end && in_range(*begin, '0', '9'); ++begin)
+		digits += static_cast<char>(*begin);
+	return digits.size() != size;
 }
 
-template <class Iterator, typename Frac>
-bool try_parse_frac(Iterator & begin, Iterator end, Frac & frac)
+template <class Iterator>
+bool try_parse_frac(Iterator & begin, Iterator end, std::string & digits)
 {
 	Iterator try_iter = begin;
-	Frac factor = 0.1, result = 0;
-	if (!try_consume(try_iter, end, '.'))
-		return false;
-	const auto start_iter = try_iter;
-	while (try_iter != end) {
-		const auto chr = *try_iter++;
-		if (!std::isdigit(chr))
-			break;
-		result += (chr - '0') * factor;
-		factor /= 10;
-	}
-	if (try_iter == start_iter)
+	if (!try_consume(try_iter, end, '.')
+	    || !try_parse_digits(try_iter, end, digits))
 		return false;
 	begin = try_iter;
-	frac = result;
 	return true;
 }
 
-template <class Iterator, typename Exp>
-bool try_parse_exp(Iterator & begin, Iterator end, Exp & exp)
+template <class Iterator>
+bool try_parse_exp(Iterator & begin, Iterator end, long long & exp)
 {
-	Exp num;
+	long long num = 0;
 	Iterator try_iter = begin;
 	if (!try_consume(try_iter, end, 'e')
 	    && !try_consume(try_iter, end, 'E'))
 		return false;
 	const int sig = parse_sign_or(try_iter, end, +1);
-	if (!try_parse_num(try_iter, end, num))
+	const Iterator num_start = try_iter;
+	for (; try_iter != end && in_range(*try_iter, '0', '9'); ++try_iter) {
+		if (num < max_decimal_exponent)
+			num = num * 10 + (*try_iter - '0');
+	}
+	if (try_iter == num_start)
 		return false;
 	begin = try_iter;
 	exp = sig * num;
@@ -404,40 +540,59 @@ constexpr bool is_valid_number_start(Char chr)
 	return std::isdigit(chr) || chr == '-' || chr == '.';
 }
 
-template <class Iterator>
-Value parse_number(Iterator & begin, Iterator end)
+template <class Iterator, class Handler>
+void parse_number(Iterator & begin, Iterator end, Handler & handler)
 {
-	Int dec = 0, exp = 0; Real frac = 0;
+	std::string digits;
+	long long exp = 0;
 	if (!is_valid_number_start(peek_char(begin, end)))
 		throw ParseError("invalid value");
 	const long sig = parse_sign_or(begin, end, +1);
 	const auto dec_start = peek_char(begin, end);
-	const bool has_dec = try_parse_num(begin, end, dec);
-	const bool has_frac = try_parse_frac(begin, end, frac);
+	const bool has_dec = try_parse_digits(begin, end, digits);
+	const auto dec_size = digits.size();
+	const bool has_frac = try_parse_frac(begin, end, digits);
 	const bool has_exp = try_parse_exp(begin, end, exp);
 	const bool is_real = has_frac || has_exp;
+	const char * const data = digits.data();
 	if (!is_real) {
 		if (!has_dec)
 			throw ParseError("invalid value");
-		if (dec_start == '0' && dec != 0)
+		if (dec_start == '0' && digits.find_first_not_of('0') != digits.npos)
 			throw ParseError("invalid value");
-		return static_cast<Int>(sig * dec);
+		Int dec;
+		const auto magnitude = accumulate_digits(data, data + dec_size, 0);
+		if (try_make_int(sig < 0, magnitude, dec_size, dec)) {
+			handler.on_int(dec);
+			return;
+		}
 	}
-	return sig * (dec + frac) * std::pow(10, exp);
+	const Real real = make_real(data, data + dec_size, data + dec_size,
+	                            data + digits.size(), exp);
+	handler.on_real(sig < 0 ? -real : real);
 }
 
-template <class Iterator>
-Value parse_value(Iterator & begin, Iterator end)
+template <class Iterator, class Handler>
+void parse_value(Iterator & begin, Iterator end, Handler & handler)
 {
 	skip_whitespace(begin, end);
 	switch (peek_char(begin, end)) {
-	case 'n': return parse_null(begin, end);
-	case 't': return parse_true(begin, end);
-	case 'f': return parse_false(begin, end);
-	case '"': return parse_string(begin, end);
-	case '[': return parse_array(begin, end);
-	case '{': return parse_object(begin, end);
-	default:  return parse_number(begin, end);
+	case 'n':
+		parse_null(begin, end);
+		handler.on_null();
+		return;
+	case 't':
+		handler.on_bool(parse_true(begin, end));
+		return;
+	case 'f':
+		handler.on_bool(parse_false(begin, end));
+		return;
+	case '"':
+		handler.on_string(parse_string(begin, end));
+		return;
+	case '[': return parse_array(begin, end, handler);
+	case '{': return parse_object(begin, end, handler);
+	default:  return parse_number(begin, end, handler);
 	}
 }
 
@@ -446,14 +601,59 @@ Value parse_value(Iterator & begin, Iterator end)
 template <class Iterator>
 Value parse(Iterator begin, Iterator end)
 {
-	return detail::parse_value(begin, end);
+	ValueBuilder builder;
+	detail::parse_value(begin, end, builder);
+	return builder.take();
+}
+
+namespace detail {
+
+REJSON_EXPORT Value parse_stream(std::istream & is);
+
+template <typename Char>
+Value parse_stream(std::basic_istream<Char> & is)
+{
+	std::basic_string<Char> text;
+	Char block[4096];
+	while (const auto count = is.rdbuf()->sgetn(block, sizeof block / sizeof *block))
+		text.append(block, count);
+	is.setstate(std::ios_base::eofbit);
+	return parse(basic_string_view<Char>(text.data(), text.size()));
+}
+
 }
 
 template <typename Char>
 Value parse(std::basic_istream<Char> & is)
 {
-	return parse(std::istream_iterator<Char>(is),
-	             std::istream_iterator<Char>());
+	return detail::parse_stream(is);
+}
+
+template <class Handler>
+void parse(detail::string_view sv, Handler & handler)
+{
+	const detail::PaddedBuffer buffer { sv };
+	detail::buffer::parse(buffer, handler);
+}
+
+template <class Iterator, class Handler>
+void parse(Iterator begin, Iterator end, Handler & handler)
+{
+	detail::parse_value(begin, end, handler);
+}
+
+template <class Handler>
+void parse_file(const std::string & path, Handler & handler, FileAccess access)
+{
+	const detail::MappedFile file { path, access };
+	detail::buffer::parse(file, handler);
+}
+
+template <class Handler>
+void parse_indexed(detail::string_view sv, Handler & handler)
+{
+	const detail::PaddedBuffer buffer { sv };
+	detail::indexed::parse(buffer, handler);
 }
 
 }
@@ -1,26 +1,71 @@
 #ifndef REJSON_PATH_HPP_
 #define REJSON_PATH_HPP_
 
+#include <rejson/key_table.hpp>
 #include <rejson/value.hpp>
 #include <rejson/detail/optional.hpp>
 #include <rejson/detail/string_view.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace rejson {
 
+// Path compiled into segments. Besides object keys, with their hashes, and
+// array indices, paths may hold wildcards ("[*]" or ".*"), slices of arrays
+// ("[2:10]", with either bound optional and negative ones counting from
+// the end) and recursive descent ("..key"), which match any number of
+// values.
 class REJSON_EXPORT Path
 {
 public:
+	enum class SegmentKind : unsigned char {
+		Key, Index, Wildcard, Slice, Descendants
+	};
+
+	// Descendants segments stand for a value and everything below it, and
+	// are always followed by the segment applied to each of those.
+	struct Segment
+	{
+		String key;
+		SegmentKind kind;
+		std::uint64_t hash;
+		std::size_t index;
+		std::ptrdiff_t start;
+		std::ptrdiff_t stop;
+	};
+
 	Path(const char * path);
 	Path(detail::string_view path);
 
+	// Interns the keys of the path, which makes looking them up in values
+	// parsed with the same table a matter of comparing addresses.
+	Path(detail::string_view path, KeyTable & keys);
+
+	// First value matched by the path, if any. Keys and indices applied to
+	// values of the wrong type throw TypeError, unless after a segment
+	// matching several values, where they just match nothing.
 	Value * resolve(Value & v) const;
 	const Value * resolve(const Value & v) const;
 
+	// Every value matched by the path, in document order.
+	void resolve_all(Value & v, std::vector<Value *> & out) const;
+	void resolve_all(const Value & v, std::vector<const Value *> & out) const;
+	void resolve_all(Value & v, const std::function<void (Value &)> & callback) const;
+	void resolve_all(const Value & v,
+	                 const std::function<void (const Value &)> & callback) const;
+
+	const std::vector<Segment> & segments() const;
+
+	// Compiled path shared through a bounded process-wide cache, so that
+	// repeating the same path text does not compile it again.
+	static std::shared_ptr<const Path> cached(detail::string_view path);
+
 private:
-	std::vector<std::function<Value * (Value &)>> resolvers_;
+	std::vector<Segment> segments_;
 };
 
 REJSON_EXPORT
@@ -35,6 +80,19 @@ detail::optional<Value> get(const Value && root, const Path & path);
 REJSON_EXPORT
 Value get_value_or(const Value & root, const Path & path, const Value & defval);
 
+// Path text given as a C string, usually a literal, goes through the cache.
+REJSON_EXPORT
+Value * get(Value & root, const char * path);
+
+REJSON_EXPORT
+const Value * get(const Value & root, const char * path);
+
+REJSON_EXPORT
+detail::optional<Value> get(const Value && root, const char * path);
+
+REJSON_EXPORT
+Value get_value_or(const Value & root, const char * path, const Value & defval);
+
 }
 
 #endif
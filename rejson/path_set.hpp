@@ -0,0 +1,75 @@
+#ifndef REJSON_PATH_SET_HPP_
+#define REJSON_PATH_SET_HPP_
+
+#include <rejson/export.h>
+#include <rejson/path.hpp>
+#include <rejson/value.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace rejson {
+
+namespace detail {
+
+class SelectiveParser;
+
+}
+
+// Paths merged into a trie of their segments, so that evaluating all of
+// them takes one traversal, with each distinct prefix looked up once.
+class REJSON_EXPORT PathSet
+{
+public:
+	PathSet();
+
+	// Adds a path and returns the index of its result.
+	std::size_t add(const Path & path);
+
+	std::size_t size() const;
+
+	// Sets each result to the first value matched by its path, or to null.
+	// Segments applied to values of the wrong type match nothing.
+	void resolve(Value & root, std::vector<Value *> & results) const;
+	void resolve(const Value & root, std::vector<const Value *> & results) const;
+
+private:
+	friend class detail::SelectiveParser;
+
+	struct Node
+	{
+		Path::Segment segment;
+		std::vector<std::size_t> children;
+		std::vector<std::size_t> results;
+	};
+
+	template <class Result>
+	void visit(const Node & node, Value & value, std::vector<Result> & results) const;
+
+	template <class Result>
+	void match(const Node & node, Value & value, std::vector<Result> & results) const;
+
+	std::vector<Node> nodes_;
+	std::size_t size_;
+};
+
+// How parse_selected goes over the values outside the paths: checking them
+// as parse would, or only finding where they end.
+enum class SkipMode : unsigned char {
+	Validate, Unchecked
+};
+
+// Parses only what the paths can reach. Values matched by a path are built
+// in full, containers on the way to them hold only the members that may
+// lead to a match, with skipped array elements left as nulls to keep the
+// indices of later ones, and everything else is skipped without being
+// built. Resolving the paths of the set on the result finds the same
+// values as on the whole document. Slices from the end and recursive
+// descent need the whole subtree they apply to, which is then built.
+REJSON_EXPORT Value parse_selected(detail::string_view sv, const PathSet & paths,
+                                   SkipMode mode = SkipMode::Validate);
+
+}
+
+#endif
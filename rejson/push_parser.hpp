@@ -0,0 +1,439 @@
+#ifndef REJSON_PUSH_PARSER_HPP_
+#define REJSON_PUSH_PARSER_HPP_
+
+#include <rejson/error.hpp>
+#include <rejson/parse.hpp>
+#include <rejson/value.hpp>
+#include <rejson/detail/buffer.hpp>
+#include <rejson/detail/ctype.hpp>
+#include <rejson/detail/string_view.hpp>
+#include <rejson/detail/utf8.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rejson {
+
+// Incremental parser reporting events to a handler as input arrives in
+// arbitrary chunks. Chunks may split tokens, escapes or numbers anywhere;
+// whatever is left unfinished is kept until the next call to feed().
+template <class Handler>
+class BasicPushParser
+{
+public:
+	explicit BasicPushParser(Handler & handler);
+
+	// Consumes input up to the end of the chunk or the end of the current
+	// top-level value, whichever comes first, and returns the bytes used.
+	std::size_t feed(detail::string_view chunk);
+
+	// Signals the end of input, which completes a trailing top-level number.
+	void finish();
+
+	// Whether the last call to feed() or finish() completed a value.
+	bool done() const;
+
+	void reset();
+
+private:
+	enum class State {
+		Value, Element, ArrayStart, ObjectStart, Key, Colon, Next,
+		String, Escape, Unicode, Literal, Number, Done
+	};
+
+	struct Frame
+	{
+		bool is_object;
+		std::size_t size;
+	};
+
+	const char * step(const char * pos, const char * end);
+	const char * begin_value(const char * pos);
+	void begin_string(bool is_key);
+	void end_string(detail::string_view str);
+	void end_literal();
+	void end_unicode();
+	bool continues_number(char chr) const;
+	void end_number();
+	void end_container();
+	void end_value();
+	void flush_surrogate();
+
+	Handler & handler_;
+	State state_;
+	std::vector<Frame> frames_;
+	std::string scratch_;
+	std::string token_;
+	const char * literal_;
+	char literal_start_;
+	char hex_[4];
+	std::size_t hex_size_;
+	char32_t code_pt_;
+	char32_t high_pt_;
+	bool is_key_;
+};
+
+// Push parser building a Value out of every top-level document it reads.
+class REJSON_EXPORT PushParser
+{
+public:
+	explicit PushParser(const Allocator<char> & alloc = {});
+
+	PushParser(const PushParser &) = delete;
+	PushParser & operator=(const PushParser &) = delete;
+
+	std::vector<Value> feed(detail::string_view chunk);
+	std::vector<Value> finish();
+
+	void reset();
+
+private:
+	ValueBuilder builder_;
+	BasicPushParser<ValueBuilder> parser_;
+};
+
+template <class Handler>
+BasicPushParser<Handler>::BasicPushParser(Handler & handler)
+	: handler_ { handler }, state_ { State::Value }, literal_ { nullptr }
+	, literal_start_ { 0 }, hex_size_ { 0 }, code_pt_ { 0 }, high_pt_ { 0 }
+	, is_key_ { false } {}
+
+template <class Handler>
+std::size_t BasicPushParser<Handler>::feed(detail::string_view chunk)
+{
+	if (state_ == State::Done)
+		state_ = State::Value;
+	const char * const begin = chunk.data();
+	const char * const end = begin + chunk.size();
+	const char * pos = begin;
+	while (pos != end && state_ != State::Done)
+		pos = step(pos, end);
+	return pos - begin;
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::finish()
+{
+	switch (state_) {
+	case State::Number:
+		if (frames_.empty())
+			return end_number();
+		break;
+	case State::Value:
+		if (frames_.empty())
+			return;
+		break;
+	case State::Done:
+		return;
+	default:
+		break;
+	}
+	throw ParseError("unexpected end of input");
+}
+
+template <class Handler>
+bool BasicPushParser<Handler>::done() const
+{
+	return state_ == State::Done;
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::reset()
+{
+	state_ = State::Value;
+	frames_.clear();
+	scratch_.clear();
+	token_.clear();
+	high_pt_ = 0;
+}
+
+template <class Handler>
+const char * BasicPushParser<Handler>::step(const char * pos, const char * end)
+{
+	using detail::is_space;
+	switch (state_) {
+	case State::Value:
+	case State::Element:
+	case State::ArrayStart:
+		while (is_space(*pos)) {
+			if (++pos == end)
+				return pos;
+		}
+		if (state_ == State::ArrayStart && *pos == ']')
+			return end_container(), pos + 1;
+		if (state_ == State::Element && (*pos == ',' || *pos == ']'))
+			throw ParseError("unexpected ',' token");
+		return begin_value(pos);
+	case State::ObjectStart:
+	case State::Key:
+		while (is_space(*pos)) {
+			if (++pos == end)
+				return pos;
+		}
+		if (*pos == '"')
+			return begin_string(true), pos + 1;
+		if (state_ == State::ObjectStart && *pos == '}')
+			return end_container(), pos + 1;
+		if (state_ == State::Key && (*pos == ',' || *pos == '}'))
+			throw ParseError("unexpected ',' token");
+		throw ParseError("expected '\"' token");
+	case State::Colon:
+		while (is_space(*pos)) {
+			if (++pos == end)
+				return pos;
+		}
+		if (*pos != ':')
+			throw ParseError("expected ':' token");
+		state_ = State::Value;
+		return pos + 1;
+	case State::Next: {
+		while (is_space(*pos)) {
+			if (++pos == end)
+				return pos;
+		}
+		const bool is_object = frames_.back().is_object;
+		if (*pos == ',') {
+			state_ = is_object ? State::Key : State::Element;
+			return pos + 1;
+		}
+		if (*pos == (is_object ? '}' : ']'))
+			return end_container(), pos + 1;
+		throw ParseError(is_object ? "expected ',' or '}' token"
+		                           : "expected ',' or ']' token");
+	}
+	case State::String: {
+		const char * run = pos;
+		while (pos != end && !detail::is_string_delimiter(*pos))
+			++pos;
+		if (run != pos) {
+			flush_surrogate();
+			// Strings read in one go are handed out without a copy.
+			if (pos != end && *pos == '"' && scratch_.empty())
+				return end_string({ run, std::size_t(pos - run) }), pos + 1;
+			scratch_.append(run, pos);
+		}
+		if (pos == end)
+			return pos;
+		if (*pos == '\\') {
+			state_ = State::Escape;
+			return pos + 1;
+		}
+		if (*pos != '"')
+			throw ParseError("unescaped data in string");
+		flush_surrogate();
+		end_string({ scratch_.data(), scratch_.size() });
+		return pos + 1;
+	}
+	case State::Escape:
+		if (*pos == 'u') {
+			state_ = State::Unicode;
+			hex_size_ = 0;
+			code_pt_ = 0;
+			return pos + 1;
+		}
+		state_ = State::String;
+		flush_surrogate();
+		switch (*pos) {
+		case 'b': scratch_ += '\b'; break;
+		case 'f': scratch_ += '\f'; break;
+		case 'n': scratch_ += '\n'; break;
+		case 'r': scratch_ += '\r'; break;
+		case 't': scratch_ += '\t'; break;
+		default:  scratch_ += *pos;
+		}
+		return pos + 1;
+	case State::Unicode: {
+		const int xdigit = detail::buffer::parse_xdigit(*pos);
+		if (xdigit < 0) {
+			// Not a code point after all, so keep what was read as is.
+			flush_surrogate();
+			scratch_ += 'u';
+			scratch_.append(hex_, hex_size_);
+			state_ = State::String;
+			return pos;
+		}
+		hex_[hex_size_++] = *pos;
+		code_pt_ = code_pt_ << 4 | xdigit;
+		if (hex_size_ == sizeof(hex_))
+			end_unicode();
+		return pos + 1;
+	}
+	case State::Literal:
+		if (*pos != *literal_)
+			throw ParseError("invalid value");
+		if (*++literal_ == '\0')
+			end_literal();
+		return pos + 1;
+	case State::Number:
+		while (continues_number(*pos)) {
+			token_ += *pos;
+			if (++pos == end)
+				return pos;
+		}
+		end_number();
+		return pos;
+	case State::Done:
+		break;
+	}
+	return pos;
+}
+
+template <class Handler>
+const char * BasicPushParser<Handler>::begin_value(const char * pos)
+{
+	switch (*pos) {
+	case '[':
+		handler_.on_array_begin();
+		frames_.push_back({ false, 0 });
+		state_ = State::ArrayStart;
+		break;
+	case '{':
+		handler_.on_object_begin();
+		frames_.push_back({ true, 0 });
+		state_ = State::ObjectStart;
+		break;
+	case '"':
+		begin_string(false);
+		break;
+	case 'n':
+	case 't':
+	case 'f':
+		literal_ = *pos == 'n' ? "ull" : *pos == 't' ? "rue" : "alse";
+		literal_start_ = *pos;
+		state_ = State::Literal;
+		break;
+	default:
+		if (*pos != '-' && !detail::buffer::is_digit(*pos))
+			throw ParseError("invalid value");
+		token_.clear();
+		state_ = State::Number;
+		return pos;
+	}
+	return pos + 1;
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::begin_string(bool is_key)
+{
+	scratch_.clear();
+	high_pt_ = 0;
+	is_key_ = is_key;
+	state_ = State::String;
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::end_string(detail::string_view str)
+{
+	if (is_key_) {
+		handler_.on_key(str);
+		state_ = State::Colon;
+		return;
+	}
+	handler_.on_string(str);
+	end_value();
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::end_literal()
+{
+	switch (literal_start_) {
+	case 'n': handler_.on_null(); break;
+	case 't': handler_.on_bool(true); break;
+	case 'f': handler_.on_bool(false); break;
+	}
+	end_value();
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::end_unicode()
+{
+	state_ = State::String;
+	if (high_pt_ != 0 && detail::in_range(code_pt_, U'\xdc00', U'\xdfff')) {
+		detail::append_utf8(0x10000 + ((high_pt_ - 0xd800) << 10)
+		                            + (code_pt_ - 0xdc00), scratch_);
+		high_pt_ = 0;
+		return;
+	}
+	flush_surrogate();
+	if (detail::in_range(code_pt_, U'\xd800', U'\xdbff'))
+		high_pt_ = code_pt_;
+	else
+		detail::append_utf8(code_pt_, scratch_);
+}
+
+// Whether the character extends the number read so far, by the grammar of
+// the buffer engine, which stops at the same place on the whole input.
+template <class Handler>
+bool BasicPushParser<Handler>::continues_number(char chr) const
+{
+	if (detail::buffer::is_digit(chr))
+		return true;
+	const char last = token_.empty() ? '\0' : token_.back();
+	switch (chr) {
+	case '-':
+		return token_.empty() || last == 'e' || last == 'E';
+	case '+':
+		return last == 'e' || last == 'E';
+	case '.':
+		return detail::buffer::is_digit(last)
+		       && token_.find_first_of(".eE") == std::string::npos;
+	case 'e':
+	case 'E':
+		return detail::buffer::is_digit(last)
+		       && token_.find_first_of("eE") == std::string::npos;
+	default:
+		return false;
+	}
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::end_number()
+{
+	// The buffer engine reads ahead into the padding and stops at its first
+	// null character; reporting the end one past it makes a truncated
+	// number an invalid value.
+	const auto size = token_.size();
+	token_.append(detail::buffer_padding, '\0');
+	const char * pos = token_.data();
+	const char * const end = pos + size;
+	detail::buffer::parse_number(pos, end + 1, handler_);
+	if (pos != end)
+		throw ParseError("invalid value");
+	end_value();
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::end_container()
+{
+	const Frame frame = frames_.back();
+	frames_.pop_back();
+	if (frame.is_object)
+		handler_.on_object_end(frame.size);
+	else
+		handler_.on_array_end(frame.size);
+	end_value();
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::end_value()
+{
+	if (frames_.empty()) {
+		state_ = State::Done;
+		return;
+	}
+	++frames_.back().size;
+	state_ = State::Next;
+}
+
+template <class Handler>
+void BasicPushParser<Handler>::flush_surrogate()
+{
+	if (high_pt_ != 0)
+		detail::append_utf8(high_pt_, scratch_);
+	high_pt_ = 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef REJSON_STATIC_PATH_HPP_
+#define REJSON_STATIC_PATH_HPP_
+
+#include <rejson/value.hpp>
+#include <rejson/detail/optional.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace rejson {
+
+namespace detail {
+
+struct StaticSegment
+{
+	const char * key;
+	std::size_t size;
+	std::uint64_t hash;
+	std::size_t index;
+	bool is_index;
+};
+
+constexpr bool is_path_digit(char chr)
+{
+	return chr >= '0' && chr <= '9';
+}
+
+constexpr std::size_t find_path_char(const char * path, std::size_t size,
+                                     std::size_t pos, char chr, char other)
+{
+	while (pos < size && path[pos] != chr && path[pos] != other)
+		++pos;
+	return pos;
+}
+
+// Only keys in brackets starting with a digit are indices.
+constexpr StaticSegment make_static_segment(const char * key, std::size_t size,
+                                            bool in_brackets)
+{
+	// Static paths always match a single value, so there are no wildcards.
+	if (size == 0 || (size == 1 && key[0] == '*'))
+		throw std::invalid_argument("invalid json path");
+	if (!in_brackets || !is_path_digit(key[0]))
+		return { key, size, hash_bytes(key, size), 0, false };
+	std::size_t index = 0;
+	for (std::size_t i = 0; i < size; ++i) {
+		if (!is_path_digit(key[i]))
+			throw std::invalid_argument("invalid json path");
+		index = index * 10 + static_cast<std::size_t>(key[i] - '0');
+	}
+	return { nullptr, 0, 0, index, true };
+}
+
+// Splits a path in the syntax of Path, storing as many segments as there
+// is room for, and returns their number. Throwing while evaluated by the
+// compiler turns malformed paths into build errors.
+constexpr std::size_t scan_static_path(const char * path, std::size_t size,
+                                       StaticSegment * segments, std::size_t capacity)
+{
+	std::size_t count = 0, pos = 0;
+	while (pos < size) {
+		StaticSegment segment {};
+		if (path[pos] == '[') {
+			const auto end = find_path_char(path, size, pos + 1, ']', ']');
+			if (end == size)
+				throw std::invalid_argument("invalid json path");
+			segment = make_static_segment(path + pos + 1, end - pos - 1, true);
+			pos = end + 1;
+		} else {
+			if (path[pos] == '.')
+				++pos;
+			const auto end = find_path_char(path, size, pos, '.', '[');
+			segment = make_static_segment(path + pos, end - pos, false);
+			pos = end;
+		}
+		if (count < capacity)
+			segments[count] = segment;
+		++count;
+	}
+	return count;
+}
+
+template <std::size_t L>
+constexpr std::size_t count_path_segments(const char (&path)[L])
+{
+	return scan_static_path(path, L - 1, nullptr, 0);
+}
+
+}
+
+// Path split and hashed by the compiler, for paths known at build time.
+// Made with REJSON_PATH, which rejects malformed paths at build time.
+template <std::size_t N>
+class StaticPath
+{
+public:
+	template <std::size_t L>
+	constexpr explicit StaticPath(const char (&path)[L])
+		: segments_ {}
+	{
+		detail::scan_static_path(path, L - 1, segments_, N);
+	}
+
+	constexpr std::size_t size() const
+	{
+		return N;
+	}
+
+	constexpr const detail::StaticSegment & operator[](std::size_t pos) const
+	{
+		return segments_[pos];
+	}
+
+	Value * resolve(Value & v) const;
+	const Value * resolve(const Value & v) const;
+
+private:
+	detail::StaticSegment segments_[N ? N : 1];
+};
+
+#define REJSON_PATH(path) \
+	::rejson::StaticPath<::rejson::detail::count_path_segments(path)> { path }
+
+template <std::size_t N>
+Value * StaticPath<N>::resolve(Value & v) const
+{
+	Value * result = &v;
+	for (std::size_t i = 0; i < N; ++i) {
+		const auto & segment = segments_[i];
+		if (segment.is_index) {
+			auto & array = result->as_array();
+			if (segment.index >= array.size())
+				return nullptr;
+			result = &array[segment.index];
+		} else {
+			auto & object = result->as_object();
+			const auto iter = object.find(
+				detail::string_view(segment.key, segment.size), segment.hash);
+			if (iter == object.end())
+				return nullptr;
+			result = &iter->second;
+		}
+	}
+	return result;
+}
+
+template <std::size_t N>
+const Value * StaticPath<N>::resolve(const Value & cv) const
+{
+	return resolve(const_cast<Value &>(cv));
+}
+
+template <std::size_t N>
+Value * get(Value & root, const StaticPath<N> & path)
+{
+	return path.resolve(root);
+}
+
+template <std::size_t N>
+const Value * get(const Value & root, const StaticPath<N> & path)
+{
+	return path.resolve(root);
+}
+
+template <std::size_t N>
+detail::optional<Value> get(const Value && root, const StaticPath<N> & path)
+{
+	const auto value = path.resolve(root);
+	if (!value)
+		return detail::nullopt;
+	return *value;
+}
+
+template <std::size_t N>
+Value get_value_or(const Value & root, const StaticPath<N> & path, const Value & defval)
+{
+	const auto v = path.resolve(root);
+	return v ? *v : defval;
+}
+
+}
+
+#endif
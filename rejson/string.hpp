@@ -0,0 +1,492 @@
+#ifndef REJSON_STRING_HPP_
+#define REJSON_STRING_HPP_
+
+#include <rejson/arena.hpp>
+#include <rejson/export.h>
+#include <rejson/detail/string_view.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+namespace rejson {
+
+namespace detail {
+
+constexpr std::uint64_t hash_bytes(const char * data, std::size_t size)
+{
+	std::uint64_t hash = 0xcbf29ce484222325;
+	for (std::size_t i = 0; i < size; ++i) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+}
+
+// Byte string taking 15 bytes, so that it fits in a Value next to its type.
+// Up to 14 characters are stored inline; longer strings live in a block
+// that starts with the allocator it came from. Only the block knows its
+// arena, so strings that grow out of the inline buffer use the heap.
+//
+// The inline buffer holds the number of unused characters in its last
+// byte, which doubles as the null terminator when the buffer is full.
+// Strings hold no pointers into themselves and may be moved bytewise.
+//
+// Strings may also refer to a key owned by a KeyTable. Those share the
+// table's characters, carry their precomputed hash, and compare by address
+// with keys of the same table. They must not be changed in place.
+class REJSON_EXPORT String
+{
+public:
+	using value_type = char;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = char &;
+	using const_reference = const char &;
+	using pointer = char *;
+	using const_pointer = const char *;
+	using iterator = char *;
+	using const_iterator = const char *;
+	using allocator_type = Allocator<char>;
+
+	static constexpr size_type npos = static_cast<size_type>(-1);
+	static constexpr size_type inline_capacity = 14;
+
+	String() noexcept;
+	String(const char * str, const Allocator<char> & alloc = {});
+	String(const char * data, size_type size, const Allocator<char> & alloc = {});
+	String(const String & other);
+	String(const String & other, const Allocator<char> & alloc);
+	String(String && other) noexcept;
+	~String();
+
+	String & operator=(const String & other);
+	String & operator=(String && other) noexcept;
+
+	const char * data() const noexcept;
+	char * data() noexcept;
+	const char * c_str() const noexcept;
+
+	size_type size() const noexcept;
+	size_type length() const noexcept;
+	size_type capacity() const noexcept;
+	bool empty() const noexcept;
+
+	Allocator<char> get_allocator() const noexcept;
+
+	iterator begin() noexcept;
+	iterator end() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cbegin() const noexcept;
+	const_iterator cend() const noexcept;
+
+	char & operator[](size_type pos) noexcept;
+	const char & operator[](size_type pos) const noexcept;
+	char & front() noexcept;
+	const char & front() const noexcept;
+	char & back() noexcept;
+	const char & back() const noexcept;
+
+	void reserve(size_type capacity);
+	void clear() noexcept;
+
+	String & assign(const char * data, size_type size);
+	String & append(const char * data, size_type size);
+	String & append(const char * first, const char * last);
+
+	template <class InputIt>
+	String & append(InputIt first, InputIt last);
+
+	void push_back(char chr);
+	String & operator+=(char chr);
+	String & operator+=(detail::string_view sv);
+
+	int compare(detail::string_view sv) const noexcept;
+
+	bool is_interned() const noexcept;
+	std::uint64_t hash() const noexcept;
+
+	operator detail::string_view() const noexcept;
+	std::string to_string() const;
+
+private:
+	friend class KeyTable;
+	friend bool operator==(const String & lhs, const String & rhs) noexcept;
+
+	struct Header
+	{
+		Arena * arena;
+		size_type capacity;
+	};
+
+	static constexpr unsigned char heap_marker = 0xff;
+	static constexpr unsigned char interned_marker = 0xfe;
+	static constexpr size_type max_heap_size = (std::uint64_t { 1 } << 48) - 1;
+
+	// Interned keys are created by their table, which stores the hash of
+	// each key right before its characters.
+	static String interned(const char * data, std::uint32_t size,
+	                       std::uint16_t table) noexcept;
+
+	bool is_inline() const noexcept;
+	std::uint16_t table() const noexcept;
+	Header * header() const noexcept;
+	char * heap_data() const noexcept;
+	size_type heap_size() const noexcept;
+	void set_size(size_type size) noexcept;
+	void set_heap(char * data, size_type size) noexcept;
+	void grow(size_type capacity, const char * extra = nullptr,
+	          size_type extra_size = 0);
+	void release() noexcept;
+
+	// Heap strings keep their data pointer in the first eight bytes and a
+	// 48-bit size in the next six. Interned keys have a 32-bit size followed
+	// by the id of their table instead.
+	unsigned char bytes_[inline_capacity + 1];
+};
+
+static_assert(sizeof(String) == String::inline_capacity + 1,
+              "String must leave room for the Value type tag");
+
+inline String::String() noexcept
+{
+	bytes_[0] = '\0';
+	bytes_[inline_capacity] = inline_capacity;
+}
+
+inline String::String(const char * str, const Allocator<char> & alloc)
+	: String { str, std::strlen(str), alloc } {}
+
+inline String::String(String && other) noexcept
+{
+	std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+	other.bytes_[0] = '\0';
+	other.bytes_[inline_capacity] = inline_capacity;
+}
+
+inline String::~String()
+{
+	release();
+}
+
+inline String & String::operator=(String && other) noexcept
+{
+	if (this != &other) {
+		release();
+		std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+		other.bytes_[0] = '\0';
+		other.bytes_[inline_capacity] = inline_capacity;
+	}
+	return *this;
+}
+
+inline bool String::is_inline() const noexcept
+{
+	return bytes_[inline_capacity] <= inline_capacity;
+}
+
+inline bool String::is_interned() const noexcept
+{
+	return bytes_[inline_capacity] == interned_marker;
+}
+
+inline std::uint16_t String::table() const noexcept
+{
+	return static_cast<std::uint16_t>(bytes_[12] | bytes_[13] << 8);
+}
+
+inline std::uint64_t String::hash() const noexcept
+{
+	if (!is_interned())
+		return detail::hash_bytes(data(), size());
+	std::uint64_t hash;
+	std::memcpy(&hash, heap_data() - sizeof(hash), sizeof(hash));
+	return hash;
+}
+
+inline char * String::heap_data() const noexcept
+{
+	char * data;
+	std::memcpy(&data, bytes_, sizeof(data));
+	return data;
+}
+
+inline String::Header * String::header() const noexcept
+{
+	return reinterpret_cast<Header *>(heap_data()) - 1;
+}
+
+inline String::size_type String::heap_size() const noexcept
+{
+	size_type size = 0;
+	for (int i = is_interned() ? 3 : 5; i >= 0; --i)
+		size = size << 8 | bytes_[sizeof(char *) + i];
+	return size;
+}
+
+inline void String::set_size(size_type size) noexcept
+{
+	if (is_inline()) {
+		bytes_[inline_capacity] = static_cast<unsigned char>(inline_capacity - size);
+		bytes_[size] = '\0';
+		return;
+	}
+	if (is_interned()) {
+		// Interned keys have no spare capacity, so they can only be cleared.
+		if (size == 0) {
+			bytes_[0] = '\0';
+			bytes_[inline_capacity] = inline_capacity;
+		}
+		return;
+	}
+	for (int i = 0; i < 6; ++i)
+		bytes_[sizeof(char *) + i] = static_cast<unsigned char>(size >> (8 * i));
+	heap_data()[size] = '\0';
+}
+
+inline const char * String::data() const noexcept
+{
+	return is_inline() ? reinterpret_cast<const char *>(bytes_) : heap_data();
+}
+
+inline char * String::data() noexcept
+{
+	return is_inline() ? reinterpret_cast<char *>(bytes_) : heap_data();
+}
+
+inline const char * String::c_str() const noexcept
+{
+	return data();
+}
+
+inline String::size_type String::size() const noexcept
+{
+	return is_inline() ? inline_capacity - bytes_[inline_capacity] : heap_size();
+}
+
+inline String::size_type String::length() const noexcept
+{
+	return size();
+}
+
+inline String::size_type String::capacity() const noexcept
+{
+	if (is_inline())
+		return inline_capacity;
+	return is_interned() ? 0 : header()->capacity;
+}
+
+inline bool String::empty() const noexcept
+{
+	return size() == 0;
+}
+
+inline Allocator<char> String::get_allocator() const noexcept
+{
+	return is_inline() || is_interned() ? nullptr : header()->arena;
+}
+
+inline String::iterator String::begin() noexcept
+{
+	return data();
+}
+
+inline String::iterator String::end() noexcept
+{
+	return data() + size();
+}
+
+inline String::const_iterator String::begin() const noexcept
+{
+	return data();
+}
+
+inline String::const_iterator String::end() const noexcept
+{
+	return data() + size();
+}
+
+inline String::const_iterator String::cbegin() const noexcept
+{
+	return begin();
+}
+
+inline String::const_iterator String::cend() const noexcept
+{
+	return end();
+}
+
+inline char & String::operator[](size_type pos) noexcept
+{
+	return data()[pos];
+}
+
+inline const char & String::operator[](size_type pos) const noexcept
+{
+	return data()[pos];
+}
+
+inline char & String::front() noexcept
+{
+	return data()[0];
+}
+
+inline const char & String::front() const noexcept
+{
+	return data()[0];
+}
+
+inline char & String::back() noexcept
+{
+	return data()[size() - 1];
+}
+
+inline const char & String::back() const noexcept
+{
+	return data()[size() - 1];
+}
+
+inline void String::reserve(size_type capacity)
+{
+	if (capacity > this->capacity())
+		grow(capacity);
+}
+
+inline void String::clear() noexcept
+{
+	set_size(0);
+}
+
+inline String & String::append(const char * data, size_type size)
+{
+	const auto old_size = this->size();
+	// Interned keys are copied to a block of their own before any change.
+	if (is_interned() || capacity() < old_size + size) {
+		grow(std::max(old_size + size, 2 * capacity()), data, size);
+		return *this;
+	}
+	std::memmove(this->data() + old_size, data, size);
+	set_size(old_size + size);
+	return *this;
+}
+
+inline String & String::append(const char * first, const char * last)
+{
+	return append(first, static_cast<size_type>(last - first));
+}
+
+template <class InputIt>
+String & String::append(InputIt first, InputIt last)
+{
+	for (; first != last; ++first)
+		push_back(static_cast<char>(*first));
+	return *this;
+}
+
+inline void String::push_back(char chr)
+{
+	append(&chr, 1);
+}
+
+inline String & String::operator+=(char chr)
+{
+	push_back(chr);
+	return *this;
+}
+
+inline String & String::operator+=(detail::string_view sv)
+{
+	return append(sv.data(), sv.size());
+}
+
+inline int String::compare(detail::string_view sv) const noexcept
+{
+	const auto lhs_size = size(), rhs_size = sv.size();
+	const int result = std::memcmp(data(), sv.data(), std::min(lhs_size, rhs_size));
+	if (result != 0)
+		return result;
+	return lhs_size < rhs_size ? -1 : lhs_size > rhs_size;
+}
+
+inline String::operator detail::string_view() const noexcept
+{
+	return { data(), size() };
+}
+
+inline std::string String::to_string() const
+{
+	return { data(), size() };
+}
+
+inline bool operator==(const String & lhs, detail::string_view rhs) noexcept
+{
+	return lhs.size() == rhs.size()
+	       && std::memcmp(lhs.data(), rhs.data(), rhs.size()) == 0;
+}
+
+inline bool operator==(const String & lhs, const String & rhs) noexcept
+{
+	if (lhs.is_interned() && rhs.is_interned() && lhs.table() == rhs.table())
+		return lhs.data() == rhs.data();
+	return lhs == detail::string_view(rhs);
+}
+
+inline bool operator==(const String & lhs, const char * rhs) noexcept
+{
+	return lhs == detail::string_view(rhs);
+}
+
+inline bool operator==(const String & lhs, const std::string & rhs) noexcept
+{
+	return lhs == detail::string_view(rhs.data(), rhs.size());
+}
+
+inline bool operator==(detail::string_view lhs, const String & rhs) noexcept
+{
+	return rhs == lhs;
+}
+
+inline bool operator==(const char * lhs, const String & rhs) noexcept
+{
+	return rhs == lhs;
+}
+
+inline bool operator==(const std::string & lhs, const String & rhs) noexcept
+{
+	return rhs == lhs;
+}
+
+template <class T>
+bool operator!=(const String & lhs, const T & rhs) noexcept
+{
+	return !(lhs == rhs);
+}
+
+template <class T, std::enable_if_t<
+	!std::is_same<T, String>::value
+>... >
+bool operator!=(const T & lhs, const String & rhs) noexcept
+{
+	return !(rhs == lhs);
+}
+
+inline bool operator<(const String & lhs, const String & rhs) noexcept
+{
+	return lhs.compare(rhs) < 0;
+}
+
+inline std::ostream & operator<<(std::ostream & os, const String & str)
+{
+	return os.write(str.data(), str.size());
+}
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef REJSON_UTF8_HPP_
+#define REJSON_UTF8_HPP_
+
+#include <rejson/error.hpp>
+#include <rejson/export.h>
+#include <rejson/value.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <cstddef>
+
+namespace rejson {
+
+// Whether the bytes are well-formed UTF-8: shortest forms only, with no
+// surrogates and nothing above U+10FFFF. Runs of ASCII are checked a SIMD
+// block at a time.
+REJSON_EXPORT bool is_valid_utf8(detail::string_view sv);
+
+// Handler adaptor passing events on, after checking that strings and keys
+// are valid UTF-8 and throwing ParseError otherwise. Each string is checked
+// right after being scanned, while still in cache.
+template <class Handler>
+class Utf8Validator
+{
+public:
+	explicit Utf8Validator(Handler & handler);
+
+	void on_null();
+	void on_bool(Bool b);
+	void on_int(Int i);
+	void on_real(Real r);
+	void on_string(detail::string_view s);
+	void on_key(detail::string_view k);
+	void on_array_begin();
+	void on_array_end(std::size_t size);
+	void on_object_begin();
+	void on_object_end(std::size_t size);
+
+private:
+	static void validate(detail::string_view s);
+
+	Handler & handler_;
+};
+
+template <class Handler>
+Utf8Validator<Handler>::Utf8Validator(Handler & handler)
+	: handler_ { handler } {}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_null()
+{
+	handler_.on_null();
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_bool(Bool b)
+{
+	handler_.on_bool(b);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_int(Int i)
+{
+	handler_.on_int(i);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_real(Real r)
+{
+	handler_.on_real(r);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_string(detail::string_view s)
+{
+	validate(s);
+	handler_.on_string(s);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_key(detail::string_view k)
+{
+	validate(k);
+	handler_.on_key(k);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_array_begin()
+{
+	handler_.on_array_begin();
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_array_end(std::size_t size)
+{
+	handler_.on_array_end(size);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_object_begin()
+{
+	handler_.on_object_begin();
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::on_object_end(std::size_t size)
+{
+	handler_.on_object_end(size);
+}
+
+template <class Handler>
+void Utf8Validator<Handler>::validate(detail::string_view s)
+{
+	if (!is_valid_utf8(s))
+		throw ParseError("invalid UTF-8 in string");
+}
+
+}
+
+#endif
@@ -1,61 +1,314 @@
 #ifndef REJSON_VALUE_HPP_
 #define REJSON_VALUE_HPP_
 
+#include <rejson/arena.hpp>
 #include <rejson/export.h>
-
-#include <boost/variant/variant.hpp>
-#include <boost/variant/recursive_wrapper.hpp>
-
+#include <rejson/string.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
-#include <vector>
 
 namespace rejson {
 
 class Value;
 
-using Int = int;
+using Int = std::int64_t;
 using Bool = bool;
 using Real = double;
-using String = std::string;
 using Null = std::nullptr_t;
 
-using Array = std::vector<Value>;
-using KeyValuePair = std::pair<std::string, Value>;
-using Object = std::unordered_map<std::string, Value>;
+namespace detail {
+
+struct StringHash
+{
+	std::size_t operator()(const String & str) const noexcept
+	{
+		return str.hash();
+	}
+};
+
+inline String make_string(string_view sv)
+{
+	return String(sv.data(), sv.size());
+}
+
+// Size of a range if it can be known without consuming it, or zero.
+template <class InputIt>
+std::size_t range_size(InputIt first, InputIt last, std::forward_iterator_tag)
+{
+	return static_cast<std::size_t>(std::distance(first, last));
+}
+
+template <class InputIt>
+std::size_t range_size(InputIt, InputIt, std::input_iterator_tag)
+{
+	return 0;
+}
+
+}
+
+// Sequence of values kept in one block that starts with its size, capacity
+// and the arena it came from. Empty arrays on the heap have no block at
+// all. Arrays hold no pointers into themselves and may be moved bytewise.
+class REJSON_EXPORT Array
+{
+public:
+	using value_type = Value;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = Value &;
+	using const_reference = const Value &;
+	using pointer = Value *;
+	using const_pointer = const Value *;
+	using iterator = Value *;
+	using const_iterator = const Value *;
+	using allocator_type = Allocator<Value>;
+
+	Array() noexcept;
+	explicit Array(const Allocator<Value> & alloc);
+	// Allocates room for the given number of values up front.
+	Array(const Allocator<Value> & alloc, size_type capacity);
+	Array(std::initializer_list<Value> values, const Allocator<Value> & alloc = {});
+
+	template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+	Array(InputIt first, InputIt last, const Allocator<Value> & alloc = {});
+
+	Array(const Array & other);
+	Array(const Array & other, const Allocator<Value> & alloc);
+	Array(Array && other) noexcept;
+	~Array();
+
+	Array & operator=(const Array & other);
+	Array & operator=(Array && other) noexcept;
+
+	size_type size() const noexcept;
+	size_type capacity() const noexcept;
+	bool empty() const noexcept;
+
+	Allocator<Value> get_allocator() const noexcept;
+
+	Value * data() noexcept;
+	const Value * data() const noexcept;
+
+	iterator begin() noexcept;
+	iterator end() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cbegin() const noexcept;
+	const_iterator cend() const noexcept;
+
+	Value & operator[](size_type pos) noexcept;
+	const Value & operator[](size_type pos) const noexcept;
+	Value & at(size_type pos);
+	const Value & at(size_type pos) const;
+	Value & front() noexcept;
+	const Value & front() const noexcept;
+	Value & back() noexcept;
+	const Value & back() const noexcept;
+
+	void reserve(size_type capacity);
+	void clear() noexcept;
+
+	void push_back(const Value & value);
+	void push_back(Value && value);
+	void pop_back() noexcept;
+
+	template <class... Args>
+	Value & emplace_back(Args &&... args);
+
+private:
+	struct Header
+	{
+		Arena * arena;
+		size_type size;
+		size_type capacity;
+	};
+
+	static Header * allocate(Arena * arena, size_type capacity);
+	static void deallocate(Header * header) noexcept;
+
+	void grow(size_type capacity);
+	void release() noexcept;
+
+	Header * header_;
+};
+
+using KeyValuePair = std::pair<String, Value>;
+
+// Members in insertion order, kept in one block like Array. Objects of up
+// to small_size members are searched linearly; larger ones also keep an
+// open-addressing index of member positions after the members. Keys must
+// not be changed in place.
+class REJSON_EXPORT Object
+{
+public:
+	using key_type = String;
+	using mapped_type = Value;
+	using value_type = KeyValuePair;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = KeyValuePair &;
+	using const_reference = const KeyValuePair &;
+	using pointer = KeyValuePair *;
+	using const_pointer = const KeyValuePair *;
+	using iterator = KeyValuePair *;
+	using const_iterator = const KeyValuePair *;
+	using allocator_type = Allocator<KeyValuePair>;
+
+	static constexpr size_type small_size = 16;
+
+	Object() noexcept;
+	explicit Object(const Allocator<KeyValuePair> & alloc);
+	// Allocates room for the given number of members up front.
+	Object(const Allocator<KeyValuePair> & alloc, size_type capacity);
+	Object(std::initializer_list<KeyValuePair> members,
+	       const Allocator<KeyValuePair> & alloc = {});
+
+	template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+	Object(InputIt first, InputIt last, const Allocator<KeyValuePair> & alloc = {});
+
+	Object(const Object & other);
+	Object(const Object & other, const Allocator<KeyValuePair> & alloc);
+	Object(Object && other) noexcept;
+	~Object();
+
+	Object & operator=(const Object & other);
+	Object & operator=(Object && other) noexcept;
+
+	size_type size() const noexcept;
+	size_type capacity() const noexcept;
+	bool empty() const noexcept;
+
+	Allocator<KeyValuePair> get_allocator() const noexcept;
+
+	iterator begin() noexcept;
+	iterator end() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cbegin() const noexcept;
+	const_iterator cend() const noexcept;
+
+	// Keys interned in a KeyTable are found by address and precomputed hash.
+	template <class K>
+	iterator find(const K & key) noexcept;
+
+	template <class K>
+	const_iterator find(const K & key) const noexcept;
+
+	template <class K>
+	size_type count(const K & key) const noexcept;
+
+	// Lookup with the hash of the key already known, as given by hash().
+	iterator find(const String & key, std::uint64_t hash) noexcept;
+	const_iterator find(const String & key, std::uint64_t hash) const noexcept;
+	iterator find(detail::string_view key, std::uint64_t hash) noexcept;
+	const_iterator find(detail::string_view key, std::uint64_t hash) const noexcept;
+
+	Value & at(detail::string_view key);
+	const Value & at(detail::string_view key) const;
+	Value & operator[](detail::string_view key);
+
+	// Adds a member unless the key is already present, like std::map.
+	template <class K, class... Args>
+	std::pair<iterator, bool> emplace(K && key, Args &&... args);
+
+	iterator erase(const_iterator pos);
+	size_type erase(detail::string_view key);
+
+	void reserve(size_type capacity);
+	void clear() noexcept;
+
+private:
+	struct Header
+	{
+		Arena * arena;
+		size_type size;
+		size_type capacity;
+		size_type slot_count;
+	};
+
+	struct Slot
+	{
+		std::uint32_t position;
+		std::uint32_t hash;
+	};
+
+	static Header * allocate(Arena * arena, size_type capacity);
+	static void deallocate(Header * header) noexcept;
+
+	KeyValuePair * members() const noexcept;
+	Slot * slots() const noexcept;
+
+	iterator find_key(const String & key, std::true_type) noexcept;
+	iterator find_key(detail::string_view key, std::false_type) noexcept;
+
+	template <class Key>
+	iterator find_indexed(const Key & key, std::uint64_t hash) const noexcept;
+	void index(size_type pos) noexcept;
+	void rebuild_index() noexcept;
+
+	String make_key(String && key) const noexcept;
+
+	template <class K>
+	String make_key(const K & key) const;
+
+	iterator append(KeyValuePair && member);
+	void grow(size_type capacity);
+	void release() noexcept;
+
+	Header * header_;
+};
 
 template <class T>
 struct to_json;
 
-enum class ValueType {
+enum class ValueType : unsigned char {
 	Null, Int, Real, Bool, String, Object, Array
 };
 
-class REJSON_EXPORT Value
+class REJSON_EXPORT TypeError : public std::logic_error
 {
-	using value_storage_t = boost::variant<
-		boost::blank, Int, Real, Bool, String,
-		boost::recursive_wrapper<Object>,
-		boost::recursive_wrapper<Array>
-	>;
+	using logic_error::logic_error;
+};
 
+// Values take 16 bytes: the payload followed by the type. Strings of up to
+// 14 characters are stored in place, as are the single pointers of arrays
+// and objects.
+class REJSON_EXPORT Value
+{
 public:
 	Value() noexcept;
 	Value(Null n) noexcept;
 
-	Value(Int i);
-	Value(Real f);
-	Value(Bool b);
-	Value(Array a);
-	Value(String s);
-	Value(Object o);
+	Value(Int i) noexcept;
+	Value(Real f) noexcept;
+	Value(Bool b) noexcept;
+
+	template <class I, std::enable_if_t<
+		std::is_integral<I>::value && !std::is_same<I, Bool>::value
+	>... >
+	Value(I i) noexcept;
+
+	Value(Array a) noexcept;
+	Value(String s) noexcept;
+	Value(Object o) noexcept;
 
 	Value(const char * s);
+	Value(const std::string & s);
+	Value(detail::string_view s);
 
 	Value(const Value & other);
-	Value(Value && other);
+	Value(Value && other) noexcept;
+
+	~Value();
 
 	template <class T, std::enable_if_t<
 		(sizeof(to_json<T>) > 0)
@@ -63,7 +316,7 @@ public:
 	Value(const T & t);
 
 	template <class M, std::enable_if_t<
-		std::is_constructible<std::string, typename M::key_type>::value
+		std::is_constructible<detail::string_view, typename M::key_type>::value
 		&& std::is_constructible<Value, typename M::mapped_type>::value
 	>... >
 	Value(const M & m);
@@ -99,19 +352,48 @@ public:
 	Object & as_object() &;
 	const Object & as_object() const &;
 
-	void swap(Value & other);
+	void swap(Value & other) noexcept;
 
 	Value & operator=(Array && a);
 	Value & operator=(String && s);
 	Value & operator=(Object && o);
 
 	Value & operator=(const Value & other);
-	Value & operator=(Value && other);
+	Value & operator=(Value && other) noexcept;
 
 private:
-	value_storage_t value_;
+	void check_type(ValueType type) const;
+
+	template <class T>
+	T & get() noexcept;
+
+	template <class T>
+	const T & get() const noexcept;
+
+	alignas(8) unsigned char storage_[15];
+	ValueType type_;
 };
 
+static_assert(sizeof(Value) == 16, "Value must take 16 bytes");
+
+template <class T>
+T & Value::get() noexcept
+{
+	return *reinterpret_cast<T *>(storage_);
+}
+
+template <class T>
+const T & Value::get() const noexcept
+{
+	return *reinterpret_cast<const T *>(storage_);
+}
+
+template <class I, std::enable_if_t<
+	std::is_integral<I>::value && !std::is_same<I, Bool>::value
+>... >
+Value::Value(I i) noexcept
+	: Value { static_cast<Int>(i) } {}
+
 template <class T, std::enable_if_t<
 	(sizeof(to_json<T>) > 0)
 >... >
@@ -119,11 +401,17 @@ Value::Value(const T & t)
 	: Value { to_json<T>()(t) } {}
 
 template <class M, std::enable_if_t<
-	std::is_constructible<std::string, typename M::key_type>::value
+	std::is_constructible<detail::string_view, typename M::key_type>::value
 	&& std::is_constructible<Value, typename M::mapped_type>::value
 >... >
 Value::Value(const M & m)
-	: Value { Object(m.begin(), m.end()) } {}
+	: Value { Object {} }
+{
+	auto & object = as_object();
+	object.reserve(m.size());
+	for (auto && kv : m)
+		object.emplace(detail::make_string(kv.first), kv.second);
+}
 
 template <class V, std::enable_if_t<
 	std::is_constructible<Value, typename V::value_type>::value
@@ -131,6 +419,336 @@ template <class V, std::enable_if_t<
 Value::Value(const V & v)
 	: Value { Array(v.begin(), v.end()) } {}
 
+inline Array::Array() noexcept
+	: header_ { nullptr } {}
+
+template <class InputIt, class>
+Array::Array(InputIt first, InputIt last, const Allocator<Value> & alloc)
+	: Array(alloc, detail::range_size(first, last,
+		typename std::iterator_traits<InputIt>::iterator_category {}))
+{
+	for (; first != last; ++first)
+		emplace_back(*first);
+}
+
+inline Array::Array(Array && other) noexcept
+	: header_ { other.header_ }
+{
+	other.header_ = nullptr;
+}
+
+inline Array::~Array()
+{
+	release();
+}
+
+inline Array::size_type Array::size() const noexcept
+{
+	return header_ ? header_->size : 0;
+}
+
+inline Array::size_type Array::capacity() const noexcept
+{
+	return header_ ? header_->capacity : 0;
+}
+
+inline bool Array::empty() const noexcept
+{
+	return size() == 0;
+}
+
+inline Allocator<Value> Array::get_allocator() const noexcept
+{
+	return header_ ? header_->arena : nullptr;
+}
+
+inline Value * Array::data() noexcept
+{
+	return header_ ? reinterpret_cast<Value *>(header_ + 1) : nullptr;
+}
+
+inline const Value * Array::data() const noexcept
+{
+	return header_ ? reinterpret_cast<const Value *>(header_ + 1) : nullptr;
+}
+
+inline Array::iterator Array::begin() noexcept
+{
+	return data();
+}
+
+inline Array::iterator Array::end() noexcept
+{
+	return data() + size();
+}
+
+inline Array::const_iterator Array::begin() const noexcept
+{
+	return data();
+}
+
+inline Array::const_iterator Array::end() const noexcept
+{
+	return data() + size();
+}
+
+inline Array::const_iterator Array::cbegin() const noexcept
+{
+	return begin();
+}
+
+inline Array::const_iterator Array::cend() const noexcept
+{
+	return end();
+}
+
+inline Value & Array::operator[](size_type pos) noexcept
+{
+	return data()[pos];
+}
+
+inline const Value & Array::operator[](size_type pos) const noexcept
+{
+	return data()[pos];
+}
+
+inline Value & Array::front() noexcept
+{
+	return data()[0];
+}
+
+inline const Value & Array::front() const noexcept
+{
+	return data()[0];
+}
+
+inline Value & Array::back() noexcept
+{
+	return data()[size() - 1];
+}
+
+inline const Value & Array::back() const noexcept
+{
+	return data()[size() - 1];
+}
+
+inline void Array::push_back(const Value & value)
+{
+	emplace_back(value);
+}
+
+inline void Array::push_back(Value && value)
+{
+	emplace_back(std::move(value));
+}
+
+template <class... Args>
+Value & Array::emplace_back(Args &&... args)
+{
+	if (size() == capacity()) {
+		// Built first, as the arguments may refer to the current elements.
+		Value value(std::forward<Args>(args)...);
+		grow(capacity() ? 2 * capacity() : 4);
+		const auto ptr = new (data() + header_->size) Value(std::move(value));
+		++header_->size;
+		return *ptr;
+	}
+	const auto ptr = new (data() + header_->size) Value(std::forward<Args>(args)...);
+	++header_->size;
+	return *ptr;
+}
+
+
+inline Object::Object() noexcept
+	: header_ { nullptr } {}
+
+template <class InputIt, class>
+Object::Object(InputIt first, InputIt last, const Allocator<KeyValuePair> & alloc)
+	: Object(alloc, detail::range_size(first, last,
+		typename std::iterator_traits<InputIt>::iterator_category {}))
+{
+	for (; first != last; ++first)
+		emplace((*first).first, (*first).second);
+}
+
+inline Object::Object(Object && other) noexcept
+	: header_ { other.header_ }
+{
+	other.header_ = nullptr;
+}
+
+inline Object::~Object()
+{
+	release();
+}
+
+inline Object::size_type Object::size() const noexcept
+{
+	return header_ ? header_->size : 0;
+}
+
+inline Object::size_type Object::capacity() const noexcept
+{
+	return header_ ? header_->capacity : 0;
+}
+
+inline bool Object::empty() const noexcept
+{
+	return size() == 0;
+}
+
+inline Allocator<KeyValuePair> Object::get_allocator() const noexcept
+{
+	return header_ ? header_->arena : nullptr;
+}
+
+inline KeyValuePair * Object::members() const noexcept
+{
+	return header_ ? reinterpret_cast<KeyValuePair *>(header_ + 1) : nullptr;
+}
+
+inline Object::iterator Object::begin() noexcept
+{
+	return members();
+}
+
+inline Object::iterator Object::end() noexcept
+{
+	return members() + size();
+}
+
+inline Object::const_iterator Object::begin() const noexcept
+{
+	return members();
+}
+
+inline Object::const_iterator Object::end() const noexcept
+{
+	return members() + size();
+}
+
+inline Object::const_iterator Object::cbegin() const noexcept
+{
+	return begin();
+}
+
+inline Object::const_iterator Object::cend() const noexcept
+{
+	return end();
+}
+
+inline Object::Slot * Object::slots() const noexcept
+{
+	return reinterpret_cast<Slot *>(members() + header_->capacity);
+}
+
+template <class K>
+Object::iterator Object::find(const K & key) noexcept
+{
+	return find_key(key, std::is_same<K, String>());
+}
+
+template <class K>
+Object::const_iterator Object::find(const K & key) const noexcept
+{
+	return const_cast<Object *>(this)->find(key);
+}
+
+template <class K>
+Object::size_type Object::count(const K & key) const noexcept
+{
+	return find(key) != end();
+}
+
+inline Object::iterator Object::find(const String & key, std::uint64_t hash) noexcept
+{
+	if (header_ && header_->slot_count != 0)
+		return find_indexed(key, hash);
+	for (auto & member : *this) {
+		if (member.first == key)
+			return &member;
+	}
+	return end();
+}
+
+inline Object::const_iterator Object::find(const String & key, std::uint64_t hash) const noexcept
+{
+	return const_cast<Object *>(this)->find(key, hash);
+}
+
+inline Object::iterator Object::find(detail::string_view key, std::uint64_t hash) noexcept
+{
+	if (header_ && header_->slot_count != 0)
+		return find_indexed(key, hash);
+	for (auto & member : *this) {
+		if (member.first == key)
+			return &member;
+	}
+	return end();
+}
+
+inline Object::const_iterator Object::find(detail::string_view key, std::uint64_t hash) const noexcept
+{
+	return const_cast<Object *>(this)->find(key, hash);
+}
+
+inline Object::iterator Object::find_key(const String & key, std::true_type) noexcept
+{
+	if (!key.is_interned())
+		return find_key(detail::string_view(key), std::false_type());
+	return find(key, key.hash());
+}
+
+inline Object::iterator Object::find_key(detail::string_view key, std::false_type) noexcept
+{
+	if (header_ && header_->slot_count != 0)
+		return find_indexed(key, detail::hash_bytes(key.data(), key.size()));
+	for (auto & member : *this) {
+		if (member.first == key)
+			return &member;
+	}
+	return end();
+}
+
+template <class Key>
+Object::iterator Object::find_indexed(const Key & key, std::uint64_t hash) const noexcept
+{
+	const auto fragment = static_cast<std::uint32_t>(hash);
+	const auto mask = header_->slot_count - 1;
+	const auto slots = this->slots();
+	for (auto i = fragment & mask; slots[i].position != 0; i = (i + 1) & mask) {
+		if (slots[i].hash != fragment)
+			continue;
+		const auto member = members() + slots[i].position - 1;
+		if (member->first == key)
+			return member;
+	}
+	return members() + header_->size;
+}
+
+inline String Object::make_key(String && key) const noexcept
+{
+	return std::move(key);
+}
+
+template <class K>
+String Object::make_key(const K & key) const
+{
+	const detail::string_view sv = key;
+	return String(sv.data(), sv.size(), get_allocator());
+}
+
+template <class K, class... Args>
+std::pair<Object::iterator, bool> Object::emplace(K && key, Args &&... args)
+{
+	const auto iter = find(key);
+	if (iter != end())
+		return { iter, false };
+	// Built before growing, as the arguments may refer to current members.
+	return { append({ make_key(std::forward<K>(key)),
+	                  Value(std::forward<Args>(args)...) }), true };
+}
+
 }
 
 #endif
@@ -0,0 +1,67 @@
+#include <rejson/arena.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace rejson {
+
+namespace {
+
+constexpr std::size_t default_block_size = 4096;
+constexpr std::size_t max_block_size = 1024 * 1024;
+
+}
+
+struct Arena::Block
+{
+	Block * next;
+	std::size_t size;
+};
+
+Arena::Arena() noexcept
+	: Arena { default_block_size } {}
+
+Arena::Arena(std::size_t block_size) noexcept
+	: blocks_ { nullptr }, pos_ { nullptr }, end_ { nullptr }
+	, block_size_ { std::max<std::size_t>(block_size, sizeof(Block)) } {}
+
+Arena::~Arena()
+{
+	while (blocks_) {
+		Block * next = blocks_->next;
+		std::free(blocks_);
+		blocks_ = next;
+	}
+}
+
+void * Arena::allocate_block(std::size_t size, std::size_t alignment)
+{
+	const std::size_t needed = sizeof(Block) + size + alignment;
+	const std::size_t block_size = std::max(needed, block_size_);
+	const auto block = static_cast<Block *>(std::malloc(block_size));
+	if (!block)
+		throw std::bad_alloc();
+	block->size = block_size;
+	block->next = blocks_;
+	blocks_ = block;
+	pos_ = reinterpret_cast<char *>(block + 1);
+	end_ = reinterpret_cast<char *>(block) + block_size;
+	block_size_ = std::min(block_size_ * 2, std::max(max_block_size, block_size_));
+	return allocate(size, alignment);
+}
+
+void Arena::release() noexcept
+{
+	if (!blocks_)
+		return;
+	for (Block * block = blocks_->next; block; ) {
+		Block * next = block->next;
+		std::free(block);
+		block = next;
+	}
+	blocks_->next = nullptr;
+	pos_ = reinterpret_cast<char *>(blocks_ + 1);
+	end_ = reinterpret_cast<char *>(blocks_) + blocks_->size;
+}
+
+}
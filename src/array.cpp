@@ -0,0 +1,120 @@
+#include <rejson/value.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace rejson {
+
+namespace {
+
+template <class Header>
+std::size_t block_size(std::size_t capacity)
+{
+	return 1 + (capacity * sizeof(Value) + sizeof(Header) - 1) / sizeof(Header);
+}
+
+}
+
+Array::Array(const Allocator<Value> & alloc)
+	: Array(alloc, 0) {}
+
+// Arrays in an arena always have a block, which records the arena.
+Array::Array(const Allocator<Value> & alloc, size_type capacity)
+	: header_ { alloc.arena() || capacity ? allocate(alloc.arena(), capacity) : nullptr } {}
+
+Array::Array(std::initializer_list<Value> values, const Allocator<Value> & alloc)
+	: Array(values.begin(), values.end(), alloc) {}
+
+Array::Array(const Array & other)
+	: Array(other.begin(), other.end()) {}
+
+Array::Array(const Array & other, const Allocator<Value> & alloc)
+	: Array(other.begin(), other.end(), alloc) {}
+
+Array & Array::operator=(const Array & other)
+{
+	if (this != &other)
+		*this = Array(other, get_allocator());
+	return *this;
+}
+
+Array & Array::operator=(Array && other) noexcept
+{
+	if (this != &other) {
+		release();
+		header_ = other.header_;
+		other.header_ = nullptr;
+	}
+	return *this;
+}
+
+Value & Array::at(size_type pos)
+{
+	if (pos >= size())
+		throw std::out_of_range("array index out of range");
+	return data()[pos];
+}
+
+const Value & Array::at(size_type pos) const
+{
+	if (pos >= size())
+		throw std::out_of_range("array index out of range");
+	return data()[pos];
+}
+
+void Array::reserve(size_type capacity)
+{
+	if (capacity > this->capacity())
+		grow(capacity);
+}
+
+void Array::clear() noexcept
+{
+	if (!header_)
+		return;
+	for (auto & value : *this)
+		value.~Value();
+	header_->size = 0;
+}
+
+void Array::pop_back() noexcept
+{
+	back().~Value();
+	--header_->size;
+}
+
+Array::Header * Array::allocate(Arena * arena, size_type capacity)
+{
+	const auto header = Allocator<Header>(arena).allocate(block_size<Header>(capacity));
+	*header = { arena, 0, capacity };
+	return header;
+}
+
+void Array::deallocate(Header * header) noexcept
+{
+	Allocator<Header>(header->arena).deallocate(
+		header, block_size<Header>(header->capacity));
+}
+
+void Array::grow(size_type capacity)
+{
+	const auto header = allocate(header_ ? header_->arena : nullptr, capacity);
+	if (header_) {
+		// Values are relocated bytewise, so the old block is freed as is.
+		std::memcpy(static_cast<void *>(header + 1), data(), size() * sizeof(Value));
+		header->size = header_->size;
+		deallocate(header_);
+	}
+	header_ = header;
+}
+
+void Array::release() noexcept
+{
+	if (!header_)
+		return;
+	clear();
+	deallocate(header_);
+	header_ = nullptr;
+}
+
+}
@@ -0,0 +1,46 @@
+#include <rejson/document.hpp>
+#include <rejson/parse.hpp>
+
+#include <utility>
+
+namespace rejson {
+
+namespace {
+
+const Value null_value;
+
+}
+
+Document::Document()
+	: root_ { &null_value } {}
+
+Document::Document(Document && other) noexcept
+	: arena_ { std::move(other.arena_) }, root_ { other.root_ }
+{
+	other.root_ = &null_value;
+}
+
+Document::~Document() = default;
+
+Document & Document::operator=(Document && other) noexcept
+{
+	arena_ = std::move(other.arena_);
+	root_ = other.root_;
+	other.root_ = &null_value;
+	return *this;
+}
+
+const Value & Document::root() const
+{
+	return *root_;
+}
+
+Document parse_document(detail::string_view sv)
+{
+	Document document;
+	document.arena_ = std::make_unique<Arena>();
+	document.root_ = &parse(sv, *document.arena_);
+	return document;
+}
+
+}
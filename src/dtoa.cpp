@@ -0,0 +1,367 @@
+#include <rejson/detail/dtoa.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Grisu3 as described by Florian Loitsch in "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers", with the boundaries and rounding
+// of the double-conversion implementation. It finds the shortest output
+// for all but about one value in two hundred, and detects those, which are
+// then written through the C library instead.
+
+namespace rejson { namespace detail {
+
+namespace {
+
+struct DiyFp
+{
+	std::uint64_t f;
+	int e;
+};
+
+DiyFp sub(DiyFp x, DiyFp y)
+{
+	return { x.f - y.f, x.e };
+}
+
+// Upper half of the 128-bit product, rounded.
+DiyFp mul(DiyFp x, DiyFp y)
+{
+	const std::uint64_t x_lo = x.f & 0xffffffff, x_hi = x.f >> 32;
+	const std::uint64_t y_lo = y.f & 0xffffffff, y_hi = y.f >> 32;
+	const std::uint64_t p0 = x_lo * y_lo, p1 = x_lo * y_hi;
+	const std::uint64_t p2 = x_hi * y_lo, p3 = x_hi * y_hi;
+	std::uint64_t q = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff);
+	q += std::uint64_t { 1 } << 31;
+	return { p3 + (p2 >> 32) + (p1 >> 32) + (q >> 32), x.e + y.e + 64 };
+}
+
+DiyFp normalize(DiyFp x)
+{
+	while ((x.f >> 63) == 0) {
+		x.f <<= 1;
+		--x.e;
+	}
+	return x;
+}
+
+DiyFp normalize_to(DiyFp x, int e)
+{
+	return { x.f << (x.e - e), e };
+}
+
+struct Boundaries
+{
+	DiyFp w;
+	DiyFp minus;
+	DiyFp plus;
+};
+
+// Computes the value and the halfway points to its neighbours, all
+// normalized to the same exponent.
+Boundaries compute_boundaries(double value)
+{
+	constexpr int bias = 1023 + 52;
+	constexpr std::uint64_t hidden_bit = std::uint64_t { 1 } << 52;
+	std::uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const auto exponent = static_cast<int>(bits >> 52);
+	const std::uint64_t fraction = bits & (hidden_bit - 1);
+	const DiyFp v = exponent == 0
+		? DiyFp { fraction, 1 - bias }
+		: DiyFp { fraction + hidden_bit, exponent - bias };
+	const bool lower_is_closer = fraction == 0 && exponent > 1;
+	const DiyFp plus = normalize({ 2 * v.f + 1, v.e - 1 });
+	const DiyFp minus = lower_is_closer
+		? DiyFp { 4 * v.f - 1, v.e - 2 }
+		: DiyFp { 2 * v.f - 1, v.e - 1 };
+	return { normalize(v), normalize_to(minus, plus.e), plus };
+}
+
+struct CachedPower
+{
+	std::uint64_t f;
+	int e;
+	int k;
+};
+
+// Normalized 10^k for k = -300, -292, ..., 324.
+const CachedPower cached_powers[] = {
+	{ 0xAB70FE17C79AC6CA, -1060, -300 },
+	{ 0xFF77B1FCBEBCDC4F, -1034, -292 },
+	{ 0xBE5691EF416BD60C, -1007, -284 },
+	{ 0x8DD01FAD907FFC3C,  -980, -276 },
+	{ 0xD3515C2831559A83,  -954, -268 },
+	{ 0x9D71AC8FADA6C9B5,  -927, -260 },
+	{ 0xEA9C227723EE8BCB,  -901, -252 },
+	{ 0xAECC49914078536D,  -874, -244 },
+	{ 0x823C12795DB6CE57,  -847, -236 },
+	{ 0xC21094364DFB5637,  -821, -228 },
+	{ 0x9096EA6F3848984F,  -794, -220 },
+	{ 0xD77485CB25823AC7,  -768, -212 },
+	{ 0xA086CFCD97BF97F4,  -741, -204 },
+	{ 0xEF340A98172AACE5,  -715, -196 },
+	{ 0xB23867FB2A35B28E,  -688, -188 },
+	{ 0x84C8D4DFD2C63F3B,  -661, -180 },
+	{ 0xC5DD44271AD3CDBA,  -635, -172 },
+	{ 0x936B9FCEBB25C996,  -608, -164 },
+	{ 0xDBAC6C247D62A584,  -582, -156 },
+	{ 0xA3AB66580D5FDAF6,  -555, -148 },
+	{ 0xF3E2F893DEC3F126,  -529, -140 },
+	{ 0xB5B5ADA8AAFF80B8,  -502, -132 },
+	{ 0x87625F056C7C4A8B,  -475, -124 },
+	{ 0xC9BCFF6034C13053,  -449, -116 },
+	{ 0x964E858C91BA2655,  -422, -108 },
+	{ 0xDFF9772470297EBD,  -396, -100 },
+	{ 0xA6DFBD9FB8E5B88F,  -369,  -92 },
+	{ 0xF8A95FCF88747D94,  -343,  -84 },
+	{ 0xB94470938FA89BCF,  -316,  -76 },
+	{ 0x8A08F0F8BF0F156B,  -289,  -68 },
+	{ 0xCDB02555653131B6,  -263,  -60 },
+	{ 0x993FE2C6D07B7FAC,  -236,  -52 },
+	{ 0xE45C10C42A2B3B06,  -210,  -44 },
+	{ 0xAA242499697392D3,  -183,  -36 },
+	{ 0xFD87B5F28300CA0E,  -157,  -28 },
+	{ 0xBCE5086492111AEB,  -130,  -20 },
+	{ 0x8CBCCC096F5088CC,  -103,  -12 },
+	{ 0xD1B71758E219652C,   -77,   -4 },
+	{ 0x9C40000000000000,   -50,    4 },
+	{ 0xE8D4A51000000000,   -24,   12 },
+	{ 0xAD78EBC5AC620000,     3,   20 },
+	{ 0x813F3978F8940984,    30,   28 },
+	{ 0xC097CE7BC90715B3,    56,   36 },
+	{ 0x8F7E32CE7BEA5C70,    83,   44 },
+	{ 0xD5D238A4ABE98068,   109,   52 },
+	{ 0x9F4F2726179A2245,   136,   60 },
+	{ 0xED63A231D4C4FB27,   162,   68 },
+	{ 0xB0DE65388CC8ADA8,   189,   76 },
+	{ 0x83C7088E1AAB65DB,   216,   84 },
+	{ 0xC45D1DF942711D9A,   242,   92 },
+	{ 0x924D692CA61BE758,   269,  100 },
+	{ 0xDA01EE641A708DEA,   295,  108 },
+	{ 0xA26DA3999AEF774A,   322,  116 },
+	{ 0xF209787BB47D6B85,   348,  124 },
+	{ 0xB454E4A179DD1877,   375,  132 },
+	{ 0x865B86925B9BC5C2,   402,  140 },
+	{ 0xC83553C5C8965D3D,   428,  148 },
+	{ 0x952AB45CFA97A0B3,   455,  156 },
+	{ 0xDE469FBD99A05FE3,   481,  164 },
+	{ 0xA59BC234DB398C25,   508,  172 },
+	{ 0xF6C69A72A3989F5C,   534,  180 },
+	{ 0xB7DCBF5354E9BECE,   561,  188 },
+	{ 0x88FCF317F22241E2,   588,  196 },
+	{ 0xCC20CE9BD35C78A5,   614,  204 },
+	{ 0x98165AF37B2153DF,   641,  212 },
+	{ 0xE2A0B5DC971F303A,   667,  220 },
+	{ 0xA8D9D1535CE3B396,   694,  228 },
+	{ 0xFB9B7CD9A4A7443C,   720,  236 },
+	{ 0xBB764C4CA7A44410,   747,  244 },
+	{ 0x8BAB8EEFB6409C1A,   774,  252 },
+	{ 0xD01FEF10A657842C,   800,  260 },
+	{ 0x9B10A4E5E9913129,   827,  268 },
+	{ 0xE7109BFBA19C0C9D,   853,  276 },
+	{ 0xAC2820D9623BF429,   880,  284 },
+	{ 0x80444B5E7AA7CF85,   907,  292 },
+	{ 0xBF21E44003ACDD2D,   933,  300 },
+	{ 0x8E679C2F5E44FF8F,   960,  308 },
+	{ 0xD433179D9C8CB841,   986,  316 },
+	{ 0x9E19DB92B4E31BA9,  1013,  324 },
+};
+
+constexpr int cached_powers_min_exp = -300;
+constexpr int cached_powers_step = 8;
+
+// Range of binary exponents that digit generation works in.
+constexpr int alpha = -60;
+constexpr int gamma = -32;
+
+// Returns c = 10^k such that alpha <= c.e + e + 64 <= gamma.
+CachedPower cached_power_for(int e)
+{
+	const int f = alpha - e - 1;
+	const int k = (f * 78913) / (1 << 18) + (f > 0);
+	const int index = (-cached_powers_min_exp + k + (cached_powers_step - 1))
+	                  / cached_powers_step;
+	return cached_powers[index];
+}
+
+int find_largest_pow10(std::uint32_t n, std::uint32_t & pow10)
+{
+	std::uint32_t p = 1000000000;
+	int digits = 10;
+	for (; digits > 1 && n < p; --digits)
+		p /= 10;
+	pow10 = p;
+	return digits;
+}
+
+// Moves the last digit towards the value while that stays in the safe
+// interval, and tells whether the result is then known to be the closest
+// to the value within it. The unit is the error of the scaled boundaries.
+bool round_weed(char * buffer, int length, std::uint64_t dist,
+                std::uint64_t unsafe, std::uint64_t rest, std::uint64_t ten_k,
+                std::uint64_t unit)
+{
+	const std::uint64_t small_dist = dist - unit;
+	const std::uint64_t big_dist = dist + unit;
+	while (rest < small_dist && unsafe - rest >= ten_k
+	       && (rest + ten_k < small_dist
+	           || small_dist - rest >= rest + ten_k - small_dist)) {
+		--buffer[length - 1];
+		rest += ten_k;
+	}
+	if (rest < big_dist && unsafe - rest >= ten_k
+	    && (rest + ten_k < big_dist || big_dist - rest > rest + ten_k - big_dist))
+		return false;
+	return 2 * unit <= rest && rest <= unsafe - 4 * unit;
+}
+
+// Generates digits until they fall in the unsafe interval, the boundaries
+// widened by their error, and tells whether they are the shortest.
+bool generate_digits(char * buffer, int & length, int & exponent,
+                     DiyFp low, DiyFp w, DiyFp high)
+{
+	std::uint64_t unit = 1;
+	const DiyFp too_low { low.f - unit, low.e };
+	const DiyFp too_high { high.f + unit, high.e };
+	std::uint64_t unsafe = sub(too_high, too_low).f;
+	const DiyFp one { std::uint64_t { 1 } << -w.e, w.e };
+	auto p1 = static_cast<std::uint32_t>(too_high.f >> -one.e);
+	std::uint64_t p2 = too_high.f & (one.f - 1);
+
+	std::uint32_t pow10;
+	for (int n = find_largest_pow10(p1, pow10); n > 0; pow10 /= 10) {
+		buffer[length++] = static_cast<char>('0' + p1 / pow10);
+		p1 %= pow10;
+		--n;
+		const std::uint64_t rest = (std::uint64_t { p1 } << -one.e) + p2;
+		if (rest < unsafe) {
+			exponent += n;
+			return round_weed(buffer, length, sub(too_high, w).f, unsafe, rest,
+			                  std::uint64_t { pow10 } << -one.e, unit);
+		}
+	}
+
+	int m = 0;
+	do {
+		p2 *= 10;
+		unit *= 10;
+		unsafe *= 10;
+		buffer[length++] = static_cast<char>('0' + (p2 >> -one.e));
+		p2 &= one.f - 1;
+		++m;
+	} while (p2 >= unsafe);
+	exponent -= m;
+	return round_weed(buffer, length, sub(too_high, w).f * unit, unsafe, p2,
+	                  one.f, unit);
+}
+
+// Writes the digits of a positive finite value, which stands for
+// digits * 10^exponent, and tells whether they are known to be shortest.
+bool grisu3(char * buffer, int & length, int & exponent, double value)
+{
+	const Boundaries b = compute_boundaries(value);
+	const CachedPower cached = cached_power_for(b.plus.e);
+	const DiyFp c { cached.f, cached.e };
+	length = 0;
+	exponent = -cached.k;
+	return generate_digits(buffer, length, exponent, mul(b.minus, c),
+	                       mul(b.w, c), mul(b.plus, c));
+}
+
+// The shortest correctly rounded digits that read back as the value, which
+// are closest to it, for the few values Grisu3 cannot decide.
+void shortest_digits(char * buffer, int & length, int & exponent, double value)
+{
+	char text[max_real_chars];
+	for (int precision = 1;; ++precision) {
+		std::snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+		if (precision == 17 || std::strtod(text, nullptr) == value)
+			break;
+	}
+	const char * pos = text;
+	length = 0;
+	for (; *pos != 'e'; ++pos) {
+		if (*pos >= '0' && *pos <= '9')
+			buffer[length++] = *pos;
+	}
+	exponent = std::atoi(pos + 1) - (length - 1);
+}
+
+char * write_exponent(char * out, int e)
+{
+	*out++ = e < 0 ? '-' : '+';
+	unsigned k = e < 0 ? -e : e;
+	if (k >= 100) {
+		*out++ = static_cast<char>('0' + k / 100);
+		k %= 100;
+		*out++ = static_cast<char>('0' + k / 10);
+		k %= 10;
+	} else if (k >= 10) {
+		*out++ = static_cast<char>('0' + k / 10);
+		k %= 10;
+	}
+	*out++ = static_cast<char>('0' + k);
+	return out;
+}
+
+// Lays out length digits standing for digits * 10^exponent, using plain
+// notation for decimal exponents in (min_exp, max_exp] and scientific
+// notation otherwise.
+char * format_digits(char * buf, int length, int exponent)
+{
+	constexpr int min_exp = -4;
+	constexpr int max_exp = 15;
+	const int k = length;
+	const int n = length + exponent;
+	if (k <= n && n <= max_exp) {
+		std::memset(buf + k, '0', n - k);
+		buf[n] = '.';
+		buf[n + 1] = '0';
+		return buf + n + 2;
+	}
+	if (0 < n && n <= max_exp) {
+		std::memmove(buf + n + 1, buf + n, k - n);
+		buf[n] = '.';
+		return buf + k + 1;
+	}
+	if (min_exp < n && n <= 0) {
+		std::memmove(buf + 2 - n, buf, k);
+		buf[0] = '0';
+		buf[1] = '.';
+		std::memset(buf + 2, '0', -n);
+		return buf + 2 - n + k;
+	}
+	if (k == 1) {
+		++buf;
+	} else {
+		std::memmove(buf + 2, buf + 1, k - 1);
+		buf[1] = '.';
+		buf += k + 1;
+	}
+	*buf++ = 'e';
+	return write_exponent(buf, n - 1);
+}
+
+}
+
+char * format_real(double value, char * out)
+{
+	if (std::signbit(value)) {
+		*out++ = '-';
+		value = -value;
+	}
+	if (value == 0) {
+		std::memcpy(out, "0.0", 3);
+		return out + 3;
+	}
+	int length, exponent;
+	if (!grisu3(out, length, exponent, value))
+		shortest_digits(out, length, exponent, value);
+	return format_digits(out, length, exponent);
+}
+
+} }
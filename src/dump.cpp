@@ -0,0 +1,228 @@
+#include <rejson/dump.hpp>
+#include <rejson/detail/dtoa.hpp>
+#include <rejson/detail/simd.hpp>
+#include <rejson/detail/string_view.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace rejson {
+
+namespace {
+
+// Output written to a stream is flushed in chunks of about this size.
+constexpr std::size_t flush_size = 64 * 1024;
+
+const char digit_pairs[] =
+	"00010203040506070809101112131415161718192021222324"
+	"25262728293031323334353637383940414243444546474849"
+	"50515253545556575859606162636465666768697071727374"
+	"75767778798081828384858687888990919293949596979899";
+
+const char hex_digits[] = "0123456789abcdef";
+
+class Writer
+{
+public:
+	Writer(std::string & out, std::ostream * os, unsigned indent);
+
+	void write_value(const Value & value, unsigned depth);
+	void flush();
+
+private:
+	void write_int(Int i);
+	void write_real(Real r);
+	void write_string(detail::string_view str);
+	void write_array(const Array & array, unsigned depth);
+	void write_object(const Object & object, unsigned depth);
+	void write_newline(unsigned depth);
+	void maybe_flush();
+
+	std::string & out_;
+	std::ostream * os_;
+	unsigned indent_;
+};
+
+Writer::Writer(std::string & out, std::ostream * os, unsigned indent)
+	: out_ { out }, os_ { os }, indent_ { indent } {}
+
+void Writer::write_value(const Value & value, unsigned depth)
+{
+	switch (value.type()) {
+	case ValueType::Null:
+		out_.append("null", 4);
+		break;
+	case ValueType::Bool:
+		if (value.as_bool())
+			out_.append("true", 4);
+		else
+			out_.append("false", 5);
+		break;
+	case ValueType::Int:
+		write_int(value.as_int());
+		break;
+	case ValueType::Real:
+		write_real(value.as_real());
+		break;
+	case ValueType::String: {
+		const auto & str = value.as_string();
+		write_string({ str.data(), str.size() });
+		break;
+	}
+	case ValueType::Array:
+		write_array(value.as_array(), depth);
+		break;
+	case ValueType::Object:
+		write_object(value.as_object(), depth);
+		break;
+	}
+}
+
+void Writer::flush()
+{
+	if (os_ && !out_.empty()) {
+		os_->write(out_.data(), out_.size());
+		out_.clear();
+	}
+}
+
+void Writer::write_int(Int i)
+{
+	char buffer[24];
+	char * const end = buffer + sizeof(buffer);
+	char * pos = end;
+	auto n = static_cast<unsigned long long>(i);
+	if (i < 0)
+		n = 0 - n;
+	for (; n >= 100; n /= 100) {
+		pos -= 2;
+		std::memcpy(pos, digit_pairs + 2 * (n % 100), 2);
+	}
+	if (n >= 10) {
+		pos -= 2;
+		std::memcpy(pos, digit_pairs + 2 * n, 2);
+	} else {
+		*--pos = static_cast<char>('0' + n);
+	}
+	if (i < 0)
+		*--pos = '-';
+	out_.append(pos, end);
+}
+
+void Writer::write_real(Real r)
+{
+	if (!std::isfinite(r)) {
+		out_.append("null", 4);
+		return;
+	}
+	char buffer[detail::max_real_chars];
+	out_.append(buffer, detail::format_real(r, buffer));
+}
+
+void Writer::write_string(detail::string_view str)
+{
+	const char * pos = str.data();
+	const char * const end = pos + str.size();
+	out_ += '"';
+	for (;;) {
+		const char * run = pos;
+		pos = detail::find_string_delimiter(pos, end);
+		out_.append(run, pos);
+		if (pos == end)
+			break;
+		const char chr = *pos++;
+		switch (chr) {
+		case '"':  out_.append("\\\"", 2); break;
+		case '\\': out_.append("\\\\", 2); break;
+		case '\b': out_.append("\\b", 2); break;
+		case '\f': out_.append("\\f", 2); break;
+		case '\n': out_.append("\\n", 2); break;
+		case '\r': out_.append("\\r", 2); break;
+		case '\t': out_.append("\\t", 2); break;
+		default: {
+			const char escaped[] = {
+				'\\', 'u', '0', '0', hex_digits[chr >> 4], hex_digits[chr & 0xf]
+			};
+			out_.append(escaped, sizeof(escaped));
+		}
+		}
+	}
+	out_ += '"';
+}
+
+void Writer::write_array(const Array & array, unsigned depth)
+{
+	out_ += '[';
+	bool first = true;
+	for (auto && element : array) {
+		if (!first)
+			out_ += ',';
+		first = false;
+		write_newline(depth + 1);
+		write_value(element, depth + 1);
+		maybe_flush();
+	}
+	if (!first)
+		write_newline(depth);
+	out_ += ']';
+}
+
+void Writer::write_object(const Object & object, unsigned depth)
+{
+	out_ += '{';
+	bool first = true;
+	for (auto && kv : object) {
+		if (!first)
+			out_ += ',';
+		first = false;
+		write_newline(depth + 1);
+		write_string({ kv.first.data(), kv.first.size() });
+		out_ += ':';
+		if (indent_ != 0)
+			out_ += ' ';
+		write_value(kv.second, depth + 1);
+		maybe_flush();
+	}
+	if (!first)
+		write_newline(depth);
+	out_ += '}';
+}
+
+void Writer::write_newline(unsigned depth)
+{
+	if (indent_ != 0) {
+		out_ += '\n';
+		out_.append(std::size_t(indent_) * depth, ' ');
+	}
+}
+
+void Writer::maybe_flush()
+{
+	if (out_.size() >= flush_size)
+		flush();
+}
+
+}
+
+std::string dump(const Value & value, unsigned indent)
+{
+	std::string out;
+	dump(value, out, indent);
+	return out;
+}
+
+void dump(const Value & value, std::string & out, unsigned indent)
+{
+	Writer { out, nullptr, indent }.write_value(value, 0);
+}
+
+void write(const Value & value, std::ostream & os, unsigned indent)
+{
+	std::string buffer;
+	Writer writer { buffer, &os, indent };
+	writer.write_value(value, 0);
+	writer.flush();
+}
+
+}
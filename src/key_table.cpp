@@ -0,0 +1,92 @@
+#include <rejson/key_table.hpp>
+
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace rejson {
+
+namespace {
+
+// Interned keys record the id of their table, which is only reused once
+// the table is gone along with every key that could refer to it.
+std::mutex & table_ids_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::vector<bool> & table_ids()
+{
+	static std::vector<bool> ids;
+	return ids;
+}
+
+std::uint16_t acquire_table_id()
+{
+	std::lock_guard<std::mutex> lock { table_ids_mutex() };
+	auto & ids = table_ids();
+	for (std::size_t id = 0; id < ids.size(); ++id) {
+		if (!ids[id]) {
+			ids[id] = true;
+			return static_cast<std::uint16_t>(id);
+		}
+	}
+	if (ids.size() > std::numeric_limits<std::uint16_t>::max())
+		throw std::length_error("too many key tables");
+	ids.push_back(true);
+	return static_cast<std::uint16_t>(ids.size() - 1);
+}
+
+void release_table_id(std::uint16_t id)
+{
+	std::lock_guard<std::mutex> lock { table_ids_mutex() };
+	table_ids()[id] = false;
+}
+
+}
+
+KeyTable::KeyTable()
+	: id_ { acquire_table_id() } {}
+
+KeyTable::~KeyTable()
+{
+	release_table_id(id_);
+}
+
+String KeyTable::intern(detail::string_view key)
+{
+	{
+		std::shared_lock<std::shared_timed_mutex> lock { mutex_ };
+		const auto iter = keys_.find(key);
+		if (iter != keys_.end())
+			return iter->second;
+	}
+	if (key.size() > std::numeric_limits<std::uint32_t>::max())
+		throw std::length_error("key too long");
+	std::unique_lock<std::shared_timed_mutex> lock { mutex_ };
+	const auto iter = keys_.find(key);
+	if (iter != keys_.end())
+		return iter->second;
+	const auto hash = detail::hash_bytes(key.data(), key.size());
+	const auto block = static_cast<char *>(arena_.allocate(
+		sizeof(hash) + key.size() + 1, alignof(std::uint64_t)));
+	std::memcpy(block, &hash, sizeof(hash));
+	const auto chars = block + sizeof(hash);
+	std::memcpy(chars, key.data(), key.size());
+	chars[key.size()] = '\0';
+	const auto str = String::interned(
+		chars, static_cast<std::uint32_t>(key.size()), id_);
+	keys_.emplace(detail::string_view(chars, key.size()), str);
+	return str;
+}
+
+std::size_t KeyTable::size() const
+{
+	std::shared_lock<std::shared_timed_mutex> lock { mutex_ };
+	return keys_.size();
+}
+
+}
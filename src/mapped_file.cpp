@@ -0,0 +1,169 @@
+#include <rejson/detail/buffer.hpp>
+#include <rejson/detail/mapped_file.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#	define rejson_have_mmap 0
+#else
+#	define rejson_have_mmap 1
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace rejson { namespace detail {
+
+namespace {
+
+const char empty_file[buffer_padding] = {};
+
+[[noreturn]] void throw_file_error(const std::string & path)
+{
+	throw std::system_error(errno, std::generic_category(), path);
+}
+
+// Reads until end of file into a buffer grown as needed, for files whose
+// size is not known up front.
+template <class Read>
+std::unique_ptr<char []> read_padded(Read read, std::size_t & size)
+{
+	std::size_t capacity = 64 * 1024;
+	std::unique_ptr<char []> data { new char[capacity + buffer_padding] };
+	size = 0;
+	for (;;) {
+		if (size == capacity) {
+			std::unique_ptr<char []> grown { new char[capacity * 2 + buffer_padding] };
+			std::memcpy(grown.get(), data.get(), size);
+			data = std::move(grown);
+			capacity *= 2;
+		}
+		const auto count = read(data.get() + size, capacity - size);
+		if (count == 0)
+			break;
+		size += count;
+	}
+	std::memset(data.get() + size, 0, buffer_padding);
+	return data;
+}
+
+#if rejson_have_mmap
+
+class FileDescriptor
+{
+public:
+	explicit FileDescriptor(const std::string & path)
+		: fd_ { ::open(path.c_str(), O_RDONLY | O_CLOEXEC) }
+	{
+		if (fd_ < 0)
+			throw_file_error(path);
+	}
+
+	~FileDescriptor()
+	{
+		::close(fd_);
+	}
+
+	int get() const
+	{
+		return fd_;
+	}
+
+private:
+	int fd_;
+};
+
+int to_advice(FileAccess access)
+{
+	switch (access) {
+	case FileAccess::Sequential: return MADV_SEQUENTIAL;
+	case FileAccess::WillNeed:   return MADV_WILLNEED;
+	default:                     return MADV_NORMAL;
+	}
+}
+
+#endif
+
+}
+
+#if rejson_have_mmap
+
+MappedFile::MappedFile(const std::string & path, FileAccess access)
+	: data_ { empty_file }, size_ { 0 }, mapped_size_ { 0 }
+{
+	const FileDescriptor file { path };
+	struct stat status;
+	if (::fstat(file.get(), &status) != 0)
+		throw_file_error(path);
+	if (!S_ISREG(status.st_mode)) {
+		heap_ = read_padded([&] (char * data, std::size_t size) {
+			for (;;) {
+				const auto count = ::read(file.get(), data, size);
+				if (count >= 0)
+					return std::size_t(count);
+				if (errno != EINTR)
+					throw_file_error(path);
+			}
+		}, size_);
+		data_ = heap_.get();
+		return;
+	}
+	if (status.st_size == 0)
+		return;
+	// The file is mapped over the start of a range of zero pages. Past its
+	// end, the rest of its last page reads as zeros, and so do the pages
+	// after it, which make up the padding.
+	size_ = status.st_size;
+	const std::size_t page_size = ::sysconf(_SC_PAGESIZE);
+	mapped_size_ = (size_ + buffer_padding + page_size - 1) / page_size * page_size;
+	void * const area = ::mmap(nullptr, mapped_size_, PROT_READ,
+	                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (area == MAP_FAILED)
+		throw_file_error(path);
+	if (::mmap(area, size_, PROT_READ, MAP_PRIVATE | MAP_FIXED, file.get(), 0)
+	    == MAP_FAILED) {
+		const int error = errno;
+		::munmap(area, mapped_size_);
+		errno = error;
+		throw_file_error(path);
+	}
+	if (access != FileAccess::Normal)
+		::madvise(area, size_, to_advice(access));
+	data_ = static_cast<const char *>(area);
+}
+
+MappedFile::~MappedFile()
+{
+	if (mapped_size_)
+		::munmap(const_cast<char *>(data_), mapped_size_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string & path, FileAccess)
+	: data_ { empty_file }, size_ { 0 }, mapped_size_ { 0 }
+{
+	const std::unique_ptr<std::FILE, int (*)(std::FILE *)> file {
+		std::fopen(path.c_str(), "rb"), &std::fclose
+	};
+	if (!file)
+		throw_file_error(path);
+	heap_ = read_padded([&] (char * data, std::size_t size) {
+		const auto count = std::fread(data, 1, size, file.get());
+		if (count == 0 && std::ferror(file.get()))
+			throw_file_error(path);
+		return count;
+	}, size_);
+	data_ = heap_.get();
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif
+
+} }
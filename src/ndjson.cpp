@@ -0,0 +1,208 @@
+#include <rejson/ndjson.hpp>
+#include <rejson/error.hpp>
+#include <rejson/parse.hpp>
+#include <rejson/detail/buffer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace rejson {
+
+namespace {
+
+// Records are handed to workers in batches of about this many bytes.
+constexpr std::size_t batch_size = 256 * 1024;
+
+struct Record
+{
+	const char * begin;
+	const char * end;
+};
+
+struct Batch
+{
+	std::size_t first;
+	std::size_t last;
+	std::vector<Value> values;
+	std::exception_ptr error;
+	bool done;
+};
+
+// Valid records cannot hold a raw newline, even in strings, so every one
+// ends a record. Each newline is overwritten with a null character, which
+// stops the buffer engine at the end of its record as the padding does at
+// the end of the input.
+std::vector<Record> split_records(detail::PaddedBuffer & buffer)
+{
+	std::vector<Record> records;
+	char * record = buffer.data();
+	char * const end = record + (buffer.end() - buffer.begin());
+	while (const auto newline = static_cast<char *>(
+	           std::memchr(record, '\n', end - record))) {
+		*newline = '\0';
+		records.push_back({ record, newline });
+		record = newline + 1;
+	}
+	if (record < end)
+		records.push_back({ record, end });
+	return records;
+}
+
+std::vector<Batch> make_batches(const std::vector<Record> & records)
+{
+	std::vector<Batch> batches;
+	for (std::size_t first = 0; first < records.size(); ) {
+		std::size_t last = first + 1;
+		while (last < records.size()
+		       && std::size_t(records[last].end - records[first].begin) < batch_size)
+			++last;
+		batches.push_back({ first, last, {}, nullptr, false });
+		first = last;
+	}
+	return batches;
+}
+
+void parse_batch(const std::vector<Record> & records, Batch & batch)
+{
+	using namespace std::literals::string_literals;
+	std::size_t index = batch.first;
+	try {
+		for (; index < batch.last; ++index) {
+			const char * pos = records[index].begin;
+			const char * const end = records[index].end;
+			detail::buffer::skip_whitespace(pos);
+			if (pos >= end)
+				continue;
+			ValueBuilder builder;
+			detail::buffer::parse_value(pos, end, builder);
+			detail::buffer::skip_whitespace(pos);
+			if (pos < end)
+				throw ParseError("unexpected data after value");
+			batch.values.push_back(builder.take());
+		}
+	} catch (const ParseError & e) {
+		batch.error = std::make_exception_ptr(ParseError(
+			"record "s + std::to_string(index + 1) + ": " + e.what()));
+	} catch (...) {
+		batch.error = std::current_exception();
+	}
+}
+
+class Workers
+{
+public:
+	Workers(const std::vector<Record> & records, std::vector<Batch> & batches,
+	        unsigned count);
+	~Workers();
+
+	Batch & wait(std::size_t index);
+
+private:
+	void run();
+	void stop();
+
+	const std::vector<Record> & records_;
+	std::vector<Batch> & batches_;
+	std::atomic<std::size_t> next_;
+	std::mutex mutex_;
+	std::condition_variable done_;
+	std::vector<std::thread> threads_;
+};
+
+Workers::Workers(const std::vector<Record> & records,
+                 std::vector<Batch> & batches, unsigned count)
+	: records_ { records }, batches_ { batches }, next_ { 0 }
+{
+	try {
+		for (unsigned i = 0; i < count; ++i)
+			threads_.emplace_back([this] { run(); });
+	} catch (...) {
+		stop();
+		throw;
+	}
+}
+
+Workers::~Workers()
+{
+	stop();
+}
+
+void Workers::stop()
+{
+	next_ = batches_.size();
+	for (auto && thread : threads_)
+		thread.join();
+	threads_.clear();
+}
+
+Batch & Workers::wait(std::size_t index)
+{
+	Batch & batch = batches_[index];
+	std::unique_lock<std::mutex> lock { mutex_ };
+	done_.wait(lock, [&] { return batch.done; });
+	return batch;
+}
+
+void Workers::run()
+{
+	for (std::size_t index; (index = next_++) < batches_.size(); ) {
+		parse_batch(records_, batches_[index]);
+		{
+			std::lock_guard<std::mutex> lock { mutex_ };
+			batches_[index].done = true;
+		}
+		done_.notify_all();
+	}
+}
+
+void deliver(Batch & batch, const std::function<void (Value)> & callback)
+{
+	for (auto && value : batch.values)
+		callback(std::move(value));
+	batch.values = std::vector<Value>();
+	if (batch.error)
+		std::rethrow_exception(batch.error);
+}
+
+}
+
+std::vector<Value> parse_ndjson(detail::string_view sv, unsigned threads)
+{
+	std::vector<Value> values;
+	parse_ndjson(sv, [&](Value value) {
+		values.push_back(std::move(value));
+	}, threads);
+	return values;
+}
+
+void parse_ndjson(detail::string_view sv,
+                  const std::function<void (Value)> & callback,
+                  unsigned threads)
+{
+	detail::PaddedBuffer buffer { sv };
+	const auto records = split_records(buffer);
+	auto batches = make_batches(records);
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	threads = static_cast<unsigned>(std::min<std::size_t>(threads, batches.size()));
+	if (threads <= 1) {
+		for (auto && batch : batches) {
+			parse_batch(records, batch);
+			deliver(batch, callback);
+		}
+		return;
+	}
+	Workers workers { records, batches, threads };
+	for (std::size_t i = 0; i < batches.size(); ++i)
+		deliver(workers.wait(i), callback);
+}
+
+}
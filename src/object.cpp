@@ -0,0 +1,196 @@
+#include <rejson/value.hpp>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace rejson {
+
+namespace {
+
+// Indexed objects keep at most half of their slots occupied.
+std::size_t slot_count(std::size_t capacity)
+{
+	if (capacity <= Object::small_size)
+		return 0;
+	std::size_t count = 1;
+	while (count < 2 * capacity)
+		count *= 2;
+	return count;
+}
+
+}
+
+constexpr Object::size_type Object::small_size;
+
+Object::Object(const Allocator<KeyValuePair> & alloc)
+	: Object(alloc, 0) {}
+
+// Objects in an arena always have a block, which records the arena.
+Object::Object(const Allocator<KeyValuePair> & alloc, size_type capacity)
+	: header_ { alloc.arena() || capacity ? allocate(alloc.arena(), capacity) : nullptr } {}
+
+Object::Object(std::initializer_list<KeyValuePair> members,
+               const Allocator<KeyValuePair> & alloc)
+	: Object(members.begin(), members.end(), alloc) {}
+
+Object::Object(const Object & other)
+	: Object(other, {}) {}
+
+Object::Object(const Object & other, const Allocator<KeyValuePair> & alloc)
+	: Object(alloc, other.size())
+{
+	// Keys are known to be unique, so there is nothing to look up.
+	for (auto && member : other)
+		append({ String(member.first, alloc), member.second });
+}
+
+Object & Object::operator=(const Object & other)
+{
+	if (this != &other)
+		*this = Object(other, get_allocator());
+	return *this;
+}
+
+Object & Object::operator=(Object && other) noexcept
+{
+	if (this != &other) {
+		release();
+		header_ = other.header_;
+		other.header_ = nullptr;
+	}
+	return *this;
+}
+
+Value & Object::at(detail::string_view key)
+{
+	const auto iter = find(key);
+	if (iter == end())
+		throw std::out_of_range("object key not found");
+	return iter->second;
+}
+
+const Value & Object::at(detail::string_view key) const
+{
+	return const_cast<Object *>(this)->at(key);
+}
+
+Value & Object::operator[](detail::string_view key)
+{
+	return emplace(key).first->second;
+}
+
+Object::iterator Object::erase(const_iterator pos)
+{
+	const auto iter = const_cast<iterator>(pos);
+	iter->~KeyValuePair();
+	// Members are relocated bytewise to close the gap, keeping their order.
+	std::memmove(static_cast<void *>(iter), iter + 1, (end() - iter - 1) * sizeof(KeyValuePair));
+	--header_->size;
+	if (header_->slot_count != 0)
+		rebuild_index();
+	return iter;
+}
+
+Object::size_type Object::erase(detail::string_view key)
+{
+	const auto iter = find(key);
+	if (iter == end())
+		return 0;
+	erase(iter);
+	return 1;
+}
+
+void Object::reserve(size_type capacity)
+{
+	if (capacity > this->capacity())
+		grow(capacity);
+}
+
+void Object::clear() noexcept
+{
+	if (!header_)
+		return;
+	for (auto & member : *this)
+		member.~KeyValuePair();
+	header_->size = 0;
+	if (header_->slot_count != 0)
+		std::memset(slots(), 0, header_->slot_count * sizeof(Slot));
+}
+
+Object::Header * Object::allocate(Arena * arena, size_type capacity)
+{
+	if (capacity > std::numeric_limits<std::uint32_t>::max() - 1)
+		throw std::length_error("object too large");
+	const auto slots = slot_count(capacity);
+	const auto bytes = capacity * sizeof(KeyValuePair) + slots * sizeof(Slot);
+	const auto header = Allocator<Header>(arena).allocate(
+		1 + (bytes + sizeof(Header) - 1) / sizeof(Header));
+	*header = { arena, 0, capacity, slots };
+	std::memset(static_cast<void *>(reinterpret_cast<KeyValuePair *>(header + 1) + capacity),
+	            0, slots * sizeof(Slot));
+	return header;
+}
+
+void Object::deallocate(Header * header) noexcept
+{
+	const auto bytes = header->capacity * sizeof(KeyValuePair)
+	                   + header->slot_count * sizeof(Slot);
+	Allocator<Header>(header->arena).deallocate(
+		header, 1 + (bytes + sizeof(Header) - 1) / sizeof(Header));
+}
+
+void Object::index(size_type pos) noexcept
+{
+	const auto hash = static_cast<std::uint32_t>(members()[pos].first.hash());
+	const auto mask = header_->slot_count - 1;
+	const auto slots = this->slots();
+	auto i = hash & mask;
+	while (slots[i].position != 0)
+		i = (i + 1) & mask;
+	slots[i] = { static_cast<std::uint32_t>(pos + 1), hash };
+}
+
+void Object::rebuild_index() noexcept
+{
+	std::memset(slots(), 0, header_->slot_count * sizeof(Slot));
+	for (size_type pos = 0; pos < header_->size; ++pos)
+		index(pos);
+}
+
+Object::iterator Object::append(KeyValuePair && member)
+{
+	if (size() == capacity())
+		grow(capacity() ? 2 * capacity() : 4);
+	const auto pos = header_->size;
+	new (members() + pos) KeyValuePair(std::move(member));
+	++header_->size;
+	if (header_->slot_count != 0)
+		index(pos);
+	return members() + pos;
+}
+
+void Object::grow(size_type capacity)
+{
+	const auto header = allocate(header_ ? header_->arena : nullptr, capacity);
+	if (header_) {
+		std::memcpy(static_cast<void *>(header + 1), members(), size() * sizeof(KeyValuePair));
+		header->size = header_->size;
+		deallocate(header_);
+	}
+	header_ = header;
+	if (header_->slot_count != 0)
+		rebuild_index();
+}
+
+void Object::release() noexcept
+{
+	if (!header_)
+		return;
+	for (auto & member : *this)
+		member.~KeyValuePair();
+	deallocate(header_);
+	header_ = nullptr;
+}
+
+}
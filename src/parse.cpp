@@ -1,25 +1,147 @@
 #include <rejson/parse.hpp>
+#include <rejson/push_parser.hpp>
+#include <rejson/detail/transcode.hpp>
+
+#include <algorithm>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
 
 namespace rejson {
 
 Value parse(detail::string_view sv)
 {
-	return parse(sv.begin(), sv.end());
+	ValueBuilder builder;
+	parse(sv, builder);
+	return builder.take();
+}
+
+Value parse(detail::string_view sv, Utf8Check check)
+{
+	ValueBuilder builder;
+	if (check == Utf8Check::Strict) {
+		Utf8Validator<ValueBuilder> validator { builder };
+		parse(sv, validator);
+	} else {
+		parse(sv, builder);
+	}
+	return builder.take();
+}
+
+const Value & parse(detail::string_view sv, Arena & arena)
+{
+	ValueBuilder builder { &arena };
+	parse(sv, builder);
+	const auto root = arena.allocate(sizeof(Value), alignof(Value));
+	return *new (root) Value(builder.take());
+}
+
+Value parse(detail::string_view sv, KeyTable & keys)
+{
+	ValueBuilder builder { {}, &keys };
+	parse(sv, builder);
+	return builder.take();
+}
+
+const Value & parse(detail::string_view sv, Arena & arena, KeyTable & keys)
+{
+	ValueBuilder builder { &arena, &keys };
+	parse(sv, builder);
+	const auto root = arena.allocate(sizeof(Value), alignof(Value));
+	return *new (root) Value(builder.take());
+}
+
+Value parse_file(const std::string & path, FileAccess access)
+{
+	ValueBuilder builder;
+	parse_file(path, builder, access);
+	return builder.take();
+}
+
+const Value & parse_file(const std::string & path, Arena & arena, FileAccess access)
+{
+	ValueBuilder builder { &arena };
+	parse_file(path, builder, access);
+	const auto root = arena.allocate(sizeof(Value), alignof(Value));
+	return *new (root) Value(builder.take());
+}
+
+namespace detail {
+
+// Input is taken from the get area of the stream buffer as it is, so that
+// whatever the value does not use can be put back. Stream buffers showing
+// no get area are read a character at a time, each one taken only once the
+// parser has used it, so that nothing past the value is read or lost.
+Value parse_stream(std::istream & is)
+{
+	using traits = std::istream::traits_type;
+	constexpr std::streamsize block_size = 64 * 1024;
+	auto & buffer = *is.rdbuf();
+	ValueBuilder builder;
+	BasicPushParser<ValueBuilder> parser { builder };
+	std::unique_ptr<char []> block { new char[block_size] };
+	while (!parser.done()) {
+		auto available = buffer.in_avail();
+		if (available <= 0) {
+			const auto next = buffer.sgetc();
+			if (traits::eq_int_type(next, traits::eof())) {
+				is.setstate(std::ios_base::eofbit);
+				parser.finish();
+				break;
+			}
+			// Only what the refill brought in can be read without blocking.
+			available = buffer.in_avail();
+			if (available <= 0) {
+				const char chr = traits::to_char_type(next);
+				if (parser.feed({ &chr, 1 }))
+					buffer.sbumpc();
+				continue;
+			}
+		}
+		const auto size = buffer.sgetn(block.get(), std::min(available, block_size));
+		const auto used = std::streamsize(parser.feed({ block.get(), std::size_t(size) }));
+		for (auto i = size; i > used; --i) {
+			if (traits::eq_int_type(buffer.sputbackc(block[i - 1]), traits::eof())) {
+				is.setstate(std::ios_base::failbit);
+				break;
+			}
+		}
+	}
+	if (!parser.done())
+		throw ParseError("unexpected end of input");
+	return builder.take();
+}
+
+}
+
+namespace {
+
+template <class Buffer>
+Value parse_buffer(const Buffer & buffer)
+{
+	ValueBuilder builder;
+	detail::buffer::parse(buffer, builder);
+	return builder.take();
+}
+
 }
 
 Value parse(detail::wstring_view sv)
 {
-	return parse(sv.begin(), sv.end());
+	return parse_buffer(detail::TranscodedBuffer { sv });
 }
 
 Value parse(detail::u16string_view sv)
 {
-	return parse(sv.begin(), sv.end());
+	return parse_buffer(detail::TranscodedBuffer { sv });
 }
 
 Value parse(detail::u32string_view sv)
 {
-	return parse(sv.begin(), sv.end());
+	return parse_buffer(detail::TranscodedBuffer { sv });
 }
 
 }
@@ -1,39 +1,76 @@
 #include <rejson/path.hpp>
 #include <rejson/value.hpp>
 
+#include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace rejson {
 
 namespace {
 
-inline auto make_object_accessor(std::string key)
+using SegmentKind = Path::SegmentKind;
+
+Path::Segment make_key_segment(String key)
 {
-	return [key = std::move(key)] (Value & v) -> Value * {
-		auto & object = v.as_object();
-		const auto iter = object.find(key);
-		if (iter != object.end())
-			return &iter->second;
-		return nullptr;
-	};
+	const auto hash = key.hash();
+	return { std::move(key), SegmentKind::Key, hash, 0, 0, 0 };
 }
 
-inline auto make_array_accessor(std::size_t index)
+Path::Segment make_segment(SegmentKind kind)
 {
-	return [index] (Value & v) -> Value * {
-		auto & array = v.as_array();
-		if (index < array.size())
-			return &array[index];
-		return nullptr;
-	};
+	return { {}, kind, 0, 0, 0, 0 };
+}
+
+Path::Segment make_index_segment(std::size_t index)
+{
+	auto segment = make_segment(SegmentKind::Index);
+	segment.index = index;
+	return segment;
 }
 
-auto parse_json_path(detail::string_view path)
+std::ptrdiff_t parse_slice_bound(detail::string_view text, std::ptrdiff_t defval)
+{
+	if (text.empty())
+		return defval;
+	std::size_t pos = text[0] == '-';
+	if (pos == text.size())
+		throw std::invalid_argument("invalid json path");
+	for (auto i = pos; i < text.size(); ++i) {
+		if (!std::isdigit(static_cast<unsigned char>(text[i])))
+			throw std::invalid_argument("invalid json path");
+	}
+	return std::stol(text.to_string());
+}
+
+Path::Segment make_slice_segment(detail::string_view text, std::size_t colon)
+{
+	auto segment = make_segment(SegmentKind::Slice);
+	segment.start = parse_slice_bound(text.substr(0, colon), 0);
+	segment.stop = parse_slice_bound(text.substr(colon + 1), PTRDIFF_MAX);
+	return segment;
+}
+
+Path::Segment make_key_or_wildcard(detail::string_view key, KeyTable * keys)
+{
+	if (key.size() == 0)
+		throw std::invalid_argument("invalid json path");
+	if (key == "*")
+		return make_segment(SegmentKind::Wildcard);
+	return make_key_segment(keys ? keys->intern(key) : detail::make_string(key));
+}
+
+auto parse_json_path(detail::string_view path, KeyTable * keys)
 {
 	std::size_t pos = 0;
-	std::vector<std::function<Value *(Value &)>> resolvers;
+	std::vector<Path::Segment> segments;
 	while (pos < path.size()) {
 		switch (path[pos]) {
 		case '[': {
@@ -42,35 +79,184 @@ auto parse_json_path(detail::string_view path)
 				throw std::invalid_argument("invalid json path");
 			const std::size_t len = endpos - pos - 1;
 			const auto key = path.substr(pos + 1, len);
-			if (key.size() == 0)
-				throw std::invalid_argument("invalid json path");
-			if (std::isdigit(key.front())) {
-				const auto index = std::stol(key.to_string());
-				resolvers.emplace_back(make_array_accessor(index));
-			} else {
-				resolvers.emplace_back(make_object_accessor(key.to_string()));
-			}
+			const auto colon = key.find(':');
+			if (colon != detail::string_view::npos)
+				segments.push_back(make_slice_segment(key, colon));
+			else if (key.size() != 0 && std::isdigit(key.front()))
+				segments.push_back(make_index_segment(std::stol(key.to_string())));
+			else
+				segments.push_back(make_key_or_wildcard(key, keys));
 			pos = endpos + 1;
 			break;
 		}
 		case '.':
+			if (pos + 1 < path.size() && path[pos + 1] == '.') {
+				segments.push_back(make_segment(SegmentKind::Descendants));
+				if (pos + 2 < path.size() && path[pos + 2] == '[') {
+					pos += 2;
+					break;
+				}
+				++pos;
+			}
 			++pos;
 		default: {
 			auto endpos = path.find_first_of(".[", pos);
-			const auto key = path.substr(pos, endpos - pos);
-			if (key.size() == 0)
-				throw std::invalid_argument("invalid json path");
-			resolvers.emplace_back(make_object_accessor(key.to_string()));
+			segments.push_back(make_key_or_wildcard(path.substr(pos, endpos - pos), keys));
 			pos = endpos;
 		} }
 	}
-	return resolvers;
+	if (!segments.empty() && segments.back().kind == SegmentKind::Descendants)
+		throw std::invalid_argument("invalid json path");
+	return segments;
+}
+
+// Matches the given segments against a value and its children, handing
+// each match to the callback until it returns false.
+template <class Callback>
+bool visit(Value & value, const Path::Segment * segment,
+           const Path::Segment * end, Callback & callback)
+{
+	if (segment == end)
+		return callback(value);
+	switch (segment->kind) {
+	case SegmentKind::Key: {
+		if (!value.is_object())
+			return true;
+		auto & object = value.as_object();
+		const auto iter = object.find(segment->key, segment->hash);
+		return iter == object.end() || visit(iter->second, segment + 1, end, callback);
+	}
+	case SegmentKind::Index: {
+		if (!value.is_array())
+			return true;
+		auto & array = value.as_array();
+		return segment->index >= array.size()
+		       || visit(array[segment->index], segment + 1, end, callback);
+	}
+	case SegmentKind::Wildcard:
+		if (value.is_array()) {
+			for (auto & element : value.as_array()) {
+				if (!visit(element, segment + 1, end, callback))
+					return false;
+			}
+		} else if (value.is_object()) {
+			for (auto & member : value.as_object()) {
+				if (!visit(member.second, segment + 1, end, callback))
+					return false;
+			}
+		}
+		return true;
+	case SegmentKind::Slice: {
+		if (!value.is_array())
+			return true;
+		auto & array = value.as_array();
+		const auto size = static_cast<std::ptrdiff_t>(array.size());
+		auto start = segment->start < 0 ? segment->start + size : segment->start;
+		auto stop = segment->stop < 0 ? segment->stop + size : segment->stop;
+		start = std::max<std::ptrdiff_t>(start, 0);
+		stop = std::min(stop, size);
+		for (auto i = start; i < stop; ++i) {
+			if (!visit(array[i], segment + 1, end, callback))
+				return false;
+		}
+		return true;
+	}
+	case SegmentKind::Descendants:
+		if (!visit(value, segment + 1, end, callback))
+			return false;
+		if (value.is_array()) {
+			for (auto & element : value.as_array()) {
+				if (!visit(element, segment, end, callback))
+					return false;
+			}
+		} else if (value.is_object()) {
+			for (auto & member : value.as_object()) {
+				if (!visit(member.second, segment, end, callback))
+					return false;
+			}
+		}
+		return true;
+	}
+	return true;
+}
+
+// The cache is split into shards, each with its own lock, so that threads
+// looking up different paths rarely wait on each other. A full shard
+// forgets its oldest path; callers still holding it keep it alive.
+constexpr std::size_t cache_shards = 16;
+constexpr std::size_t cache_shard_size = 64;
+
+class PathCache
+{
+public:
+	std::shared_ptr<const Path> get(detail::string_view text);
+
+private:
+	struct TextHash
+	{
+		std::size_t operator()(detail::string_view text) const noexcept
+		{
+			return detail::hash_bytes(text.data(), text.size());
+		}
+	};
+
+	struct Entry
+	{
+		std::string text;
+		std::shared_ptr<const Path> path;
+	};
+
+	// Entries are indexed by views of their own text, which lookups can
+	// match without copying the text they are given.
+	struct Shard
+	{
+		std::mutex mutex;
+		std::unordered_map<detail::string_view, Entry *, TextHash> index;
+		std::vector<std::unique_ptr<Entry>> entries;
+		std::size_t next = 0;
+	};
+
+	Shard shards_[cache_shards];
+};
+
+std::shared_ptr<const Path> PathCache::get(detail::string_view text)
+{
+	auto & shard = shards_[TextHash()(text) % cache_shards];
+	{
+		std::lock_guard<std::mutex> lock { shard.mutex };
+		const auto iter = shard.index.find(text);
+		if (iter != shard.index.end())
+			return iter->second->path;
+	}
+	// Compiled outside the lock; should another thread get there first,
+	// its path is the one kept.
+	auto entry = std::make_unique<Entry>();
+	entry->text = text.to_string();
+	entry->path = std::make_shared<const Path>(text);
+	std::lock_guard<std::mutex> lock { shard.mutex };
+	const auto iter = shard.index.find(text);
+	if (iter != shard.index.end())
+		return iter->second->path;
+	shard.index.emplace(entry->text, entry.get());
+	auto path = entry->path;
+	if (shard.entries.size() < cache_shard_size) {
+		shard.entries.push_back(std::move(entry));
+	} else {
+		auto & oldest = shard.entries[shard.next];
+		shard.index.erase(oldest->text);
+		oldest = std::move(entry);
+		shard.next = (shard.next + 1) % cache_shard_size;
+	}
+	return path;
 }
 
 }
 
 Path::Path(detail::string_view path)
-	: resolvers_ { parse_json_path(path) } {}
+	: segments_ { parse_json_path(path, nullptr) } {}
+
+Path::Path(detail::string_view path, KeyTable & keys)
+	: segments_ { parse_json_path(path, &keys) } {}
 
 Path::Path(const char * path)
 	: Path { detail::string_view { path } } {}
@@ -78,10 +264,32 @@ Path::Path(const char * path)
 Value * Path::resolve(Value & v) const
 {
 	Value * result = &v;
-	for (auto && resolve_one : resolvers_) {
-		result = resolve_one(*result);
-		if (!result)
-			return nullptr;
+	for (auto iter = segments_.begin(); iter != segments_.end(); ++iter) {
+		switch (iter->kind) {
+		case SegmentKind::Key: {
+			auto & object = result->as_object();
+			const auto member = object.find(iter->key, iter->hash);
+			if (member == object.end())
+				return nullptr;
+			result = &member->second;
+			break;
+		}
+		case SegmentKind::Index: {
+			auto & array = result->as_array();
+			if (iter->index >= array.size())
+				return nullptr;
+			result = &array[iter->index];
+			break;
+		}
+		default: {
+			Value * first = nullptr;
+			auto callback = [&first] (Value & match) {
+				first = &match;
+				return false;
+			};
+			visit(*result, &*iter, segments_.data() + segments_.size(), callback);
+			return first;
+		} }
 	}
 	return result;
 }
@@ -91,6 +299,56 @@ const Value * Path::resolve(const Value & cv) const
 	return resolve(const_cast<Value &>(cv));
 }
 
+void Path::resolve_all(Value & v, std::vector<Value *> & out) const
+{
+	auto callback = [&out] (Value & match) {
+		out.push_back(&match);
+		return true;
+	};
+	visit(v, segments_.data(), segments_.data() + segments_.size(), callback);
+}
+
+void Path::resolve_all(const Value & cv, std::vector<const Value *> & out) const
+{
+	auto callback = [&out] (const Value & match) {
+		out.push_back(&match);
+		return true;
+	};
+	visit(const_cast<Value &>(cv), segments_.data(),
+	      segments_.data() + segments_.size(), callback);
+}
+
+void Path::resolve_all(Value & v, const std::function<void (Value &)> & callback) const
+{
+	auto visitor = [&callback] (Value & match) {
+		callback(match);
+		return true;
+	};
+	visit(v, segments_.data(), segments_.data() + segments_.size(), visitor);
+}
+
+void Path::resolve_all(const Value & cv,
+                       const std::function<void (const Value &)> & callback) const
+{
+	auto visitor = [&callback] (const Value & match) {
+		callback(match);
+		return true;
+	};
+	visit(const_cast<Value &>(cv), segments_.data(),
+	      segments_.data() + segments_.size(), visitor);
+}
+
+const std::vector<Path::Segment> & Path::segments() const
+{
+	return segments_;
+}
+
+std::shared_ptr<const Path> Path::cached(detail::string_view path)
+{
+	static PathCache cache;
+	return cache.get(path);
+}
+
 Value * get(Value & root, const Path & path)
 {
 	return path.resolve(root);
@@ -115,4 +373,24 @@ Value get_value_or(const Value & root, const Path & path, const Value & defval)
 	return v ? *v : defval;
 }
 
+Value * get(Value & root, const char * path)
+{
+	return get(root, *Path::cached(path));
+}
+
+const Value * get(const Value & root, const char * path)
+{
+	return get(root, *Path::cached(path));
+}
+
+detail::optional<Value> get(const Value && root, const char * path)
+{
+	return get(std::move(root), *Path::cached(path));
+}
+
+Value get_value_or(const Value & root, const char * path, const Value & defval)
+{
+	return get_value_or(root, *Path::cached(path), defval);
+}
+
 }
@@ -0,0 +1,343 @@
+#include <rejson/path_set.hpp>
+#include <rejson/parse.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace rejson {
+
+namespace {
+
+using SegmentKind = Path::SegmentKind;
+
+bool same_segment(const Path::Segment & lhs, const Path::Segment & rhs)
+{
+	return lhs.kind == rhs.kind && lhs.index == rhs.index && lhs.start == rhs.start
+	       && lhs.stop == rhs.stop && lhs.hash == rhs.hash && lhs.key == rhs.key;
+}
+
+}
+
+PathSet::PathSet()
+	: nodes_ (1), size_ { 0 } {}
+
+std::size_t PathSet::add(const Path & path)
+{
+	std::size_t node = 0;
+	for (auto && segment : path.segments()) {
+		const auto & children = nodes_[node].children;
+		const auto iter = std::find_if(children.begin(), children.end(),
+			[&] (std::size_t child) {
+				return same_segment(nodes_[child].segment, segment);
+			});
+		if (iter != children.end()) {
+			node = *iter;
+			continue;
+		}
+		nodes_.push_back({ segment, {}, {} });
+		nodes_[node].children.push_back(nodes_.size() - 1);
+		node = nodes_.size() - 1;
+	}
+	nodes_[node].results.push_back(size_);
+	return size_++;
+}
+
+std::size_t PathSet::size() const
+{
+	return size_;
+}
+
+void PathSet::resolve(Value & root, std::vector<Value *> & results) const
+{
+	results.assign(size_, nullptr);
+	match(nodes_[0], root, results);
+}
+
+// Nothing is changed through the results, which only become mutable for
+// the traversal.
+void PathSet::resolve(const Value & root, std::vector<const Value *> & results) const
+{
+	results.assign(size_, nullptr);
+	match(nodes_[0], const_cast<Value &>(root), results);
+}
+
+// Applies the segment of the node to the value, then the rest of the trie
+// to each match.
+template <class Result>
+void PathSet::visit(const Node & node, Value & value, std::vector<Result> & results) const
+{
+	const auto & segment = node.segment;
+	switch (segment.kind) {
+	case SegmentKind::Key:
+		if (value.is_object()) {
+			auto & object = value.as_object();
+			const auto iter = object.find(segment.key, segment.hash);
+			if (iter != object.end())
+				match(node, iter->second, results);
+		}
+		break;
+	case SegmentKind::Index:
+		if (value.is_array() && segment.index < value.as_array().size())
+			match(node, value.as_array()[segment.index], results);
+		break;
+	case SegmentKind::Wildcard:
+		if (value.is_array()) {
+			for (auto & element : value.as_array())
+				match(node, element, results);
+		} else if (value.is_object()) {
+			for (auto & member : value.as_object())
+				match(node, member.second, results);
+		}
+		break;
+	case SegmentKind::Slice:
+		if (value.is_array()) {
+			auto & array = value.as_array();
+			const auto size = static_cast<std::ptrdiff_t>(array.size());
+			auto start = segment.start < 0 ? segment.start + size : segment.start;
+			auto stop = segment.stop < 0 ? segment.stop + size : segment.stop;
+			start = std::max<std::ptrdiff_t>(start, 0);
+			stop = std::min(stop, size);
+			for (auto i = start; i < stop; ++i)
+				match(node, array[i], results);
+		}
+		break;
+	case SegmentKind::Descendants:
+		match(node, value, results);
+		if (value.is_array()) {
+			for (auto & element : value.as_array())
+				visit(node, element, results);
+		} else if (value.is_object()) {
+			for (auto & member : value.as_object())
+				visit(node, member.second, results);
+		}
+		break;
+	}
+}
+
+template <class Result>
+void PathSet::match(const Node & node, Value & value, std::vector<Result> & results) const
+{
+	for (auto result : node.results) {
+		if (!results[result])
+			results[result] = &value;
+	}
+	for (auto child : node.children)
+		visit(nodes_[child], value, results);
+}
+
+namespace detail {
+
+// Parser driven by the trie of a set. Each value is parsed along with the
+// nodes whose children are still to be applied to it, kept at the end of
+// active_ from a given position.
+class SelectiveParser
+{
+public:
+	SelectiveParser(const PathSet & paths, SkipMode mode)
+		: nodes_ (paths.nodes_), mode_ { mode } {}
+
+	Value parse(string_view sv);
+
+private:
+	using Node = PathSet::Node;
+
+	bool needs_all(std::size_t first) const;
+	std::size_t index_limit(std::size_t first) const;
+
+	void parse_value(const char *& pos, const char * end, std::size_t first);
+	void parse_array(const char *& pos, const char * end, std::size_t first);
+	void parse_object(const char *& pos, const char * end, std::size_t first);
+	void skip_value(const char *& pos, const char * end) const;
+
+	const std::vector<Node> & nodes_;
+	SkipMode mode_;
+	ValueBuilder builder_;
+	std::vector<std::size_t> active_;
+	std::string scratch_;
+};
+
+Value SelectiveParser::parse(string_view sv)
+{
+	const PaddedBuffer buffer { sv };
+	const char * pos = buffer.begin();
+	active_.assign(1, 0);
+	parse_value(pos, buffer.end(), 0);
+	return builder_.take();
+}
+
+bool SelectiveParser::needs_all(std::size_t first) const
+{
+	for (auto i = first; i < active_.size(); ++i) {
+		const auto & node = nodes_[active_[i]];
+		if (!node.results.empty())
+			return true;
+		for (auto child : node.children) {
+			const auto & segment = nodes_[child].segment;
+			if (segment.kind == SegmentKind::Descendants
+			    || (segment.kind == SegmentKind::Slice
+			        && (segment.start < 0 || segment.stop < 0)))
+				return true;
+		}
+	}
+	return false;
+}
+
+// Elements from the limit on match nothing and can be left out.
+std::size_t SelectiveParser::index_limit(std::size_t first) const
+{
+	std::size_t limit = 0;
+	for (auto i = first; i < active_.size(); ++i) {
+		for (auto child : nodes_[active_[i]].children) {
+			const auto & segment = nodes_[child].segment;
+			switch (segment.kind) {
+			case SegmentKind::Index:
+				limit = std::max(limit, segment.index + 1);
+				break;
+			case SegmentKind::Wildcard:
+				return std::numeric_limits<std::size_t>::max();
+			case SegmentKind::Slice:
+				limit = std::max(limit, static_cast<std::size_t>(segment.stop));
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	return limit;
+}
+
+void SelectiveParser::parse_value(const char *& pos, const char * end,
+                                  std::size_t first)
+{
+	if (needs_all(first))
+		return buffer::parse_value(pos, end, builder_);
+	buffer::skip_whitespace(pos);
+	switch (*pos) {
+	case '[': return parse_array(pos, end, first);
+	case '{': return parse_object(pos, end, first);
+	default:  return buffer::parse_value(pos, end, builder_);
+	}
+}
+
+void SelectiveParser::parse_array(const char *& pos, const char * end,
+                                  std::size_t first)
+{
+	const auto limit = index_limit(first);
+	std::size_t size = 0;
+	buffer::consume(pos, end, '[');
+	builder_.on_array_begin();
+	buffer::skip_whitespace(pos);
+	if (*pos == ']') {
+		++pos;
+		builder_.on_array_end(size);
+		return;
+	}
+	for (std::size_t index = 0;; ++index) {
+		const auto children_first = active_.size();
+		for (auto i = first; i < children_first; ++i) {
+			for (auto child : nodes_[active_[i]].children) {
+				const auto & segment = nodes_[child].segment;
+				const auto signed_index = static_cast<std::ptrdiff_t>(index);
+				if ((segment.kind == SegmentKind::Index && segment.index == index)
+				    || segment.kind == SegmentKind::Wildcard
+				    || (segment.kind == SegmentKind::Slice
+				        && segment.start <= signed_index && signed_index < segment.stop))
+					active_.push_back(child);
+			}
+		}
+		if (active_.size() != children_first) {
+			parse_value(pos, end, children_first);
+			++size;
+		} else {
+			skip_value(pos, end);
+			if (index < limit) {
+				builder_.on_null();
+				++size;
+			}
+		}
+		active_.resize(children_first);
+		buffer::skip_whitespace(pos);
+		switch (*pos) {
+		case ',':
+			buffer::skip_whitespace(++pos);
+			if (*pos == ',' || *pos == ']')
+				throw ParseError("unexpected ',' token");
+			break;
+		case ']':
+			++pos;
+			builder_.on_array_end(size);
+			return;
+		default:
+			buffer::fail(pos, end, "expected ',' or ']' token");
+		}
+	}
+}
+
+void SelectiveParser::parse_object(const char *& pos, const char * end,
+                                   std::size_t first)
+{
+	std::size_t size = 0;
+	buffer::consume(pos, end, '{');
+	builder_.on_object_begin();
+	buffer::skip_whitespace(pos);
+	if (*pos == '}') {
+		++pos;
+		builder_.on_object_end(size);
+		return;
+	}
+	for (;;) {
+		const auto key = buffer::parse_string(pos, end, scratch_);
+		const auto children_first = active_.size();
+		for (auto i = first; i < children_first; ++i) {
+			for (auto child : nodes_[active_[i]].children) {
+				const auto & segment = nodes_[child].segment;
+				if ((segment.kind == SegmentKind::Key && segment.key == key)
+				    || segment.kind == SegmentKind::Wildcard)
+					active_.push_back(child);
+			}
+		}
+		buffer::skip_whitespace(pos);
+		buffer::consume(pos, end, ':');
+		if (active_.size() != children_first) {
+			builder_.on_key(key);
+			parse_value(pos, end, children_first);
+			++size;
+		} else {
+			skip_value(pos, end);
+		}
+		active_.resize(children_first);
+		buffer::skip_whitespace(pos);
+		switch (*pos) {
+		case ',':
+			buffer::skip_whitespace(++pos);
+			if (*pos == ',' || *pos == '}')
+				throw ParseError("unexpected ',' token");
+			break;
+		case '}':
+			++pos;
+			builder_.on_object_end(size);
+			return;
+		default:
+			buffer::fail(pos, end, "expected ',' or '}' token");
+		}
+	}
+}
+
+void SelectiveParser::skip_value(const char *& pos, const char * end) const
+{
+	if (mode_ == SkipMode::Validate)
+		buffer::skip_value(pos, end);
+	else
+		buffer::skip_value_unchecked(pos, end);
+}
+
+}
+
+Value parse_selected(detail::string_view sv, const PathSet & paths, SkipMode mode)
+{
+	return detail::SelectiveParser(paths, mode).parse(sv);
+}
+
+}
@@ -0,0 +1,35 @@
+#include <rejson/push_parser.hpp>
+
+namespace rejson {
+
+PushParser::PushParser(const Allocator<char> & alloc)
+	: builder_ { alloc }, parser_ { builder_ } {}
+
+std::vector<Value> PushParser::feed(detail::string_view chunk)
+{
+	std::vector<Value> values;
+	while (!chunk.empty()) {
+		chunk.remove_prefix(parser_.feed(chunk));
+		if (parser_.done())
+			values.push_back(builder_.take());
+	}
+	return values;
+}
+
+std::vector<Value> PushParser::finish()
+{
+	std::vector<Value> values;
+	const bool was_done = parser_.done();
+	parser_.finish();
+	if (parser_.done() && !was_done)
+		values.push_back(builder_.take());
+	return values;
+}
+
+void PushParser::reset()
+{
+	parser_.reset();
+	builder_.clear();
+}
+
+}
@@ -0,0 +1,114 @@
+#include <rejson/string.hpp>
+
+#include <new>
+#include <stdexcept>
+
+namespace rejson {
+
+constexpr String::size_type String::npos;
+constexpr String::size_type String::inline_capacity;
+constexpr unsigned char String::heap_marker;
+constexpr unsigned char String::interned_marker;
+constexpr String::size_type String::max_heap_size;
+
+String::String(const char * data, size_type size, const Allocator<char> & alloc)
+	: String {}
+{
+	if (size <= inline_capacity) {
+		std::memcpy(bytes_, data, size);
+		set_size(size);
+		return;
+	}
+	if (size > max_heap_size)
+		throw std::length_error("string too long");
+	const auto block = static_cast<Header *>(Allocator<Header>(alloc).allocate(
+		1 + (size + sizeof(Header)) / sizeof(Header)));
+	*block = { alloc.arena(), size };
+	const auto chars = reinterpret_cast<char *>(block + 1);
+	std::memcpy(chars, data, size);
+	set_heap(chars, size);
+}
+
+// Copies of interned keys share the characters of their table.
+String::String(const String & other)
+	: String { other, {} } {}
+
+String::String(const String & other, const Allocator<char> & alloc)
+	: String {}
+{
+	if (other.is_interned())
+		std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+	else
+		*this = String { other.data(), other.size(), alloc };
+}
+
+String & String::operator=(const String & other)
+{
+	if (other.is_interned())
+		*this = String { other };
+	else if (this != &other)
+		assign(other.data(), other.size());
+	return *this;
+}
+
+String & String::assign(const char * data, size_type size)
+{
+	if (is_interned())
+		*this = String {};
+	if (size > capacity()) {
+		*this = String { data, size, get_allocator() };
+		return *this;
+	}
+	std::memmove(this->data(), data, size);
+	set_size(size);
+	return *this;
+}
+
+String String::interned(const char * data, std::uint32_t size,
+                        std::uint16_t table) noexcept
+{
+	String str;
+	std::memcpy(str.bytes_, &data, sizeof(data));
+	for (int i = 0; i < 4; ++i)
+		str.bytes_[sizeof(char *) + i] = static_cast<unsigned char>(size >> (8 * i));
+	str.bytes_[12] = static_cast<unsigned char>(table);
+	str.bytes_[13] = static_cast<unsigned char>(table >> 8);
+	str.bytes_[inline_capacity] = interned_marker;
+	return str;
+}
+
+void String::set_heap(char * data, size_type size) noexcept
+{
+	std::memcpy(bytes_, &data, sizeof(data));
+	bytes_[inline_capacity] = heap_marker;
+	set_size(size);
+}
+
+void String::grow(size_type capacity, const char * extra, size_type extra_size)
+{
+	if (capacity > max_heap_size)
+		throw std::length_error("string too long");
+	const Allocator<char> alloc = get_allocator();
+	const auto block = static_cast<Header *>(Allocator<Header>(alloc).allocate(
+		1 + (capacity + sizeof(Header)) / sizeof(Header)));
+	*block = { alloc.arena(), capacity };
+	const auto chars = reinterpret_cast<char *>(block + 1);
+	const auto old_size = size();
+	std::memcpy(chars, data(), old_size);
+	if (extra_size)
+		std::memcpy(chars + old_size, extra, extra_size);
+	release();
+	set_heap(chars, old_size + extra_size);
+}
+
+// The characters of interned keys belong to their table.
+void String::release() noexcept
+{
+	if (is_inline() || is_interned())
+		return;
+	Header * const block = header();
+	Allocator<Header>(block->arena).deallocate(
+		block, 1 + (block->capacity + sizeof(Header)) / sizeof(Header));
+}
+
+}
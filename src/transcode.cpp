@@ -0,0 +1,133 @@
+#include <rejson/error.hpp>
+#include <rejson/detail/buffer.hpp>
+#include <rejson/detail/ctype.hpp>
+#include <rejson/detail/simd.hpp>
+#include <rejson/detail/transcode.hpp>
+#include <rejson/detail/utf8.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace rejson { namespace detail {
+
+namespace {
+
+#if rejson_have_avx2 || rejson_have_sse2
+
+// Narrows 16 code units if they are all ASCII, and returns whether they
+// were.
+template <typename Char>
+std::enable_if_t<sizeof(Char) == 2, bool> narrow_ascii(const Char * in, char * out)
+{
+	const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+	const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 8));
+	const auto high_bits = _mm_and_si128(_mm_or_si128(lo, hi), _mm_set1_epi16(-0x80));
+	if (_mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, _mm_setzero_si128())) != 0xffff)
+		return false;
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(lo, hi));
+	return true;
+}
+
+template <typename Char>
+std::enable_if_t<sizeof(Char) == 4, bool> narrow_ascii(const Char * in, char * out)
+{
+	const auto units = reinterpret_cast<const __m128i *>(in);
+	const auto a = _mm_loadu_si128(units), b = _mm_loadu_si128(units + 1),
+	           c = _mm_loadu_si128(units + 2), d = _mm_loadu_si128(units + 3);
+	const auto high_bits = _mm_and_si128(
+		_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(-0x80));
+	if (_mm_movemask_epi8(_mm_cmpeq_epi32(high_bits, _mm_setzero_si128())) != 0xffff)
+		return false;
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+		_mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	return true;
+}
+
+#else
+
+template <typename Char>
+bool narrow_ascii(const Char * in, char * out)
+{
+	for (int i = 0; i < 16; ++i) {
+		if (to_code_unit(in[i]) >= 0x80)
+			return false;
+	}
+	for (int i = 0; i < 16; ++i)
+		out[i] = static_cast<char>(in[i]);
+	return true;
+}
+
+#endif
+
+// Reads one code point, moving past its code units.
+template <typename Char>
+std::enable_if_t<sizeof(Char) == 2, char32_t> next_code_point(const Char *& pos,
+                                                              const Char * end)
+{
+	const char32_t unit = to_code_unit(*pos++);
+	if (!in_range(unit, U'\xd800', U'\xdfff'))
+		return unit;
+	if (unit > 0xdbff || pos == end || !in_range(to_code_unit(*pos), U'\xdc00', U'\xdfff'))
+		throw ParseError("unpaired surrogate in input");
+	return 0x10000 + ((unit - 0xd800) << 10) + (to_code_unit(*pos++) - 0xdc00);
+}
+
+template <typename Char>
+std::enable_if_t<sizeof(Char) == 4, char32_t> next_code_point(const Char *& pos,
+                                                              const Char *)
+{
+	const char32_t unit = to_code_unit(*pos++);
+	if (unit > 0x10ffff || in_range(unit, U'\xd800', U'\xdfff'))
+		throw ParseError("invalid code point in input");
+	return unit;
+}
+
+// Each code unit takes at most three bytes in UTF-8 for UTF-16, where four
+// byte sequences come from two units, and at most four for UTF-32.
+template <typename Char>
+std::unique_ptr<char []> transcode(const Char * pos, const Char * end,
+                                   std::size_t & size)
+{
+	constexpr std::size_t max_bytes = sizeof(Char) == 2 ? 3 : 4;
+	std::unique_ptr<char []> data {
+		new char[(end - pos) * max_bytes + buffer_padding]
+	};
+	char * out = data.get();
+	while (pos != end) {
+		if (end - pos >= 16 && narrow_ascii(pos, out)) {
+			pos += 16;
+			out += 16;
+			continue;
+		}
+		const auto run_end = end - pos < 16 ? end : pos + 16;
+		while (pos < run_end)
+			out = encode_utf8(next_code_point(pos, end), out);
+	}
+	size = out - data.get();
+	std::memset(out, 0, buffer_padding);
+	return data;
+}
+
+}
+
+TranscodedBuffer::TranscodedBuffer(u16string_view sv)
+	: size_ { 0 }
+{
+	data_ = transcode(sv.data(), sv.data() + sv.size(), size_);
+}
+
+TranscodedBuffer::TranscodedBuffer(u32string_view sv)
+	: size_ { 0 }
+{
+	data_ = transcode(sv.data(), sv.data() + sv.size(), size_);
+}
+
+// Treated as UTF-16 or UTF-32 according to the size of wchar_t.
+TranscodedBuffer::TranscodedBuffer(wstring_view sv)
+	: size_ { 0 }
+{
+	data_ = transcode(sv.data(), sv.data() + sv.size(), size_);
+}
+
+} }
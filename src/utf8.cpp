@@ -0,0 +1,69 @@
+#include <rejson/utf8.hpp>
+#include <rejson/detail/simd.hpp>
+
+#include <cstdint>
+
+namespace rejson {
+
+namespace {
+
+// Checks the sequence led by a non-ASCII byte against the well-formed
+// ranges of the Unicode standard (table 3-7), and moves past it.
+bool next_sequence(const unsigned char *& pos, const unsigned char * end)
+{
+	const unsigned lead = *pos;
+	std::size_t size;
+	unsigned char low = 0x80, high = 0xbf;
+	if (lead >= 0xc2 && lead <= 0xdf) {
+		size = 2;
+	} else if (lead >= 0xe0 && lead <= 0xef) {
+		size = 3;
+		if (lead == 0xe0)
+			low = 0xa0;
+		else if (lead == 0xed)
+			high = 0x9f;
+	} else if (lead >= 0xf0 && lead <= 0xf4) {
+		size = 4;
+		if (lead == 0xf0)
+			low = 0x90;
+		else if (lead == 0xf4)
+			high = 0x8f;
+	} else {
+		return false;
+	}
+	if (std::size_t(end - pos) < size || pos[1] < low || pos[1] > high)
+		return false;
+	for (std::size_t i = 2; i < size; ++i) {
+		if ((pos[i] & 0xc0) != 0x80)
+			return false;
+	}
+	pos += size;
+	return true;
+}
+
+}
+
+bool is_valid_utf8(detail::string_view sv)
+{
+	auto pos = reinterpret_cast<const unsigned char *>(sv.data());
+	const auto end = pos + sv.size();
+	while (pos != end) {
+#if rejson_have_avx2 || rejson_have_sse2
+		if (std::size_t(end - pos) >= detail::simd_block_size) {
+			const auto mask = detail::non_ascii_mask(reinterpret_cast<const char *>(pos));
+			if (!mask) {
+				pos += detail::simd_block_size;
+				continue;
+			}
+			pos += detail::count_trailing_zeros(mask);
+		}
+#endif
+		if (*pos < 0x80)
+			++pos;
+		else if (!next_sequence(pos, end))
+			return false;
+	}
+	return true;
+}
+
+}
@@ -1,40 +1,137 @@
 #include <rejson/value.hpp>
 
-#include <boost/variant/get.hpp>
+#include <cstring>
+#include <new>
+#include <utility>
 
 namespace rejson {
 
-Value::Value() noexcept {}
-Value::Value(const Value & other) = default;
-Value::Value(Value && other) = default;
+namespace {
+
+const char * type_name(ValueType type)
+{
+	switch (type) {
+	case ValueType::Null:   return "null";
+	case ValueType::Int:    return "an int";
+	case ValueType::Real:   return "a real";
+	case ValueType::Bool:   return "a bool";
+	case ValueType::String: return "a string";
+	case ValueType::Object: return "an object";
+	case ValueType::Array:  return "an array";
+	}
+	return "unknown";
+}
+
+}
+
+Value::Value() noexcept
+	: type_ { ValueType::Null } {}
 
 Value::Value(Null n) noexcept
-	: value_ {} {}
+	: type_ { ValueType::Null } {}
 
-Value::Value(Int i)
-	: value_ { i } {}
+Value::Value(Int i) noexcept
+	: type_ { ValueType::Int }
+{
+	new (storage_) Int { i };
+}
 
-Value::Value(Real r)
-	: value_ { r } {}
+Value::Value(Real r) noexcept
+	: type_ { ValueType::Real }
+{
+	new (storage_) Real { r };
+}
 
-Value::Value(Bool b)
-	: value_ { b } {}
+Value::Value(Bool b) noexcept
+	: type_ { ValueType::Bool }
+{
+	new (storage_) Bool { b };
+}
 
-Value::Value(String s)
-	: value_ { std::move(s) } {}
+Value::Value(String s) noexcept
+	: type_ { ValueType::String }
+{
+	new (storage_) String(std::move(s));
+}
 
-Value::Value(Array a)
-	: value_ { std::move(a) } {}
+Value::Value(Array a) noexcept
+	: type_ { ValueType::Array }
+{
+	new (storage_) Array(std::move(a));
+}
 
-Value::Value(Object o)
-	: value_ { std::move(o) } {}
+Value::Value(Object o) noexcept
+	: type_ { ValueType::Object }
+{
+	new (storage_) Object(std::move(o));
+}
 
 Value::Value(const char * s)
-	: Value { std::string(s) } {}
+	: Value { String(s) } {}
+
+Value::Value(const std::string & s)
+	: Value { String(s.data(), s.size()) } {}
+
+Value::Value(detail::string_view s)
+	: Value { String(s.data(), s.size()) } {}
+
+Value::Value(const Value & other)
+	: type_ { ValueType::Null }
+{
+	switch (other.type_) {
+	case ValueType::Null:
+		break;
+	case ValueType::Int:
+		new (storage_) Int { other.get<Int>() };
+		break;
+	case ValueType::Real:
+		new (storage_) Real { other.get<Real>() };
+		break;
+	case ValueType::Bool:
+		new (storage_) Bool { other.get<Bool>() };
+		break;
+	case ValueType::String:
+		new (storage_) String(other.get<String>());
+		break;
+	case ValueType::Object:
+		new (storage_) Object(other.get<Object>());
+		break;
+	case ValueType::Array:
+		new (storage_) Array(other.get<Array>());
+		break;
+	}
+	type_ = other.type_;
+}
+
+// Every payload may be relocated bytewise, which is what moves and swaps do.
+Value::Value(Value && other) noexcept
+	: type_ { other.type_ }
+{
+	std::memcpy(storage_, other.storage_, sizeof(storage_));
+	other.type_ = ValueType::Null;
+}
+
+Value::~Value()
+{
+	switch (type_) {
+	case ValueType::String: get<String>().~String(); break;
+	case ValueType::Object: get<Object>().~Object(); break;
+	case ValueType::Array:  get<Array>().~Array(); break;
+	default: break;
+	}
+}
+
+void Value::check_type(ValueType type) const
+{
+	using namespace std::literals::string_literals;
+	if (type_ != type)
+		throw TypeError("value is "s + type_name(type_)
+		                + ", not " + type_name(type));
+}
 
 ValueType Value::type() const
 {
-	return static_cast<ValueType>(value_.which());
+	return type_;
 }
 
 bool Value::is_int() const
@@ -74,88 +171,113 @@ bool Value::is_object() const
 
 Int Value::as_int() const
 {
-	return boost::get<Int>(value_);
+	check_type(ValueType::Int);
+	return get<Int>();
 }
 
 Bool Value::as_bool() const
 {
-	return boost::get<Bool>(value_);
+	check_type(ValueType::Bool);
+	return get<Bool>();
 }
 
 Real Value::as_real() const
 {
-	return boost::get<Real>(value_);
+	check_type(ValueType::Real);
+	return get<Real>();
 }
 
 Array Value::as_array() &&
 {
-	return std::move(boost::get<Array>(value_));
+	check_type(ValueType::Array);
+	return std::move(get<Array>());
 }
 
 Array & Value::as_array() &
 {
-	return boost::get<Array>(value_);
+	check_type(ValueType::Array);
+	return get<Array>();
 }
 
 const Array & Value::as_array() const &
 {
-	return boost::get<Array>(value_);
+	check_type(ValueType::Array);
+	return get<Array>();
 }
 
 String Value::as_string() &&
 {
-	return std::move(boost::get<String>(value_));
+	check_type(ValueType::String);
+	return std::move(get<String>());
 }
 
 String & Value::as_string() &
 {
-	return boost::get<String>(value_);
+	check_type(ValueType::String);
+	return get<String>();
 }
 
 const String & Value::as_string() const &
 {
-	return boost::get<String>(value_);
+	check_type(ValueType::String);
+	return get<String>();
 }
 
 Object Value::as_object() &&
 {
-	return std::move(boost::get<Object>(value_));
+	check_type(ValueType::Object);
+	return std::move(get<Object>());
 }
 
 Object & Value::as_object() &
 {
-	return boost::get<Object>(value_);
+	check_type(ValueType::Object);
+	return get<Object>();
 }
 
 const Object & Value::as_object() const &
 {
-	return boost::get<Object>(value_);
+	check_type(ValueType::Object);
+	return get<Object>();
 }
 
-void Value::swap(Value & other)
+void Value::swap(Value & other) noexcept
 {
-	value_.swap(other.value_);
+	unsigned char storage[sizeof(storage_)];
+	std::memcpy(storage, storage_, sizeof(storage_));
+	std::memcpy(storage_, other.storage_, sizeof(storage_));
+	std::memcpy(other.storage_, storage, sizeof(storage_));
+	std::swap(type_, other.type_);
 }
 
 Value & Value::operator=(Array && a)
 {
-	value_ = std::move(a);
+	Value { std::move(a) }.swap(*this);
 	return *this;
 }
 
 Value & Value::operator=(String && s)
 {
-	value_ = std::move(s);
+	Value { std::move(s) }.swap(*this);
 	return *this;
 }
 
 Value & Value::operator=(Object && o)
 {
-	value_ = std::move(o);
+	Value { std::move(o) }.swap(*this);
 	return *this;
 }
 
-Value & Value::operator=(const Value & other) = default;
-Value & Value::operator=(Value && other) = default;
+Value & Value::operator=(const Value & other)
+{
+	Value { other }.swap(*this);
+	return *this;
+}
+
+Value & Value::operator=(Value && other) noexcept
+{
+	Value { std::move(other) }.swap(*this);
+	return *this;
+}
 
 }
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <rejson/arena.hpp>
+#include <rejson/document.hpp>
+#include <rejson/parse.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+TEST(DocumentTests, ArenaAllocationIsAligned) {
+	rejson::Arena arena;
+	arena.allocate(1, 1);
+	const auto ptr = arena.allocate(sizeof(double), alignof(double));
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % alignof(double), 0);
+}
+
+TEST(DocumentTests, ArenaServesLargeAllocations) {
+	rejson::Arena arena { 64 };
+	const auto ptr = static_cast<char *>(arena.allocate(100000, 8));
+	ptr[0] = ptr[99999] = 'x';
+	ASSERT_NE(arena.allocate(16, 8), nullptr);
+}
+
+TEST(DocumentTests, ArenaReleaseReusesMemory) {
+	rejson::Arena arena;
+	const auto first = arena.allocate(16, 8);
+	arena.release();
+	ASSERT_EQ(arena.allocate(16, 8), first);
+}
+
+TEST(DocumentTests, AllocatorUsesArena) {
+	rejson::Arena arena;
+	rejson::String str { "a string that does not fit inline", &arena };
+	ASSERT_EQ(str.get_allocator().arena(), &arena);
+}
+
+TEST(DocumentTests, CopyOfArenaValueUsesHeap) {
+	rejson::Arena arena;
+	const auto & root = rejson::parse("[\"a string long enough to allocate\"]", arena);
+	EXPECT_EQ(root.as_array().get_allocator().arena(), &arena);
+	const rejson::Value copy = root;
+	const auto & array = copy.as_array();
+	EXPECT_EQ(array.get_allocator().arena(), nullptr);
+	ASSERT_EQ(array[0].as_string().get_allocator().arena(), nullptr);
+}
+
+TEST(DocumentTests, ParseIntoArenaWorks) {
+	rejson::Arena arena;
+	const auto & root = rejson::parse("{ \"foo\": [1, 2, 3], \"bar\": \"baz\" }", arena);
+	const auto & object = root.as_object();
+	EXPECT_EQ(object.get_allocator().arena(), &arena);
+	EXPECT_EQ(object.at("foo").as_array().size(), 3);
+	ASSERT_EQ(object.at("bar").as_string(), "baz");
+}
+
+namespace {
+
+// Bytes of the arena used by whatever make() allocates from it.
+template <class Make>
+std::ptrdiff_t arena_bytes_used(Make make)
+{
+	rejson::Arena arena;
+	const auto before = static_cast<char *>(arena.allocate(1, 1));
+	const auto value = make(&arena);
+	return static_cast<char *>(arena.allocate(1, 1)) - before;
+}
+
+}
+
+TEST(DocumentTests, ContainersFromRangeAllocateOnce) {
+	const std::vector<rejson::Value> values { 1, 2, 3, 4 };
+	EXPECT_EQ(arena_bytes_used([&] (rejson::Arena * arena) {
+		return rejson::Array(values.begin(), values.end(), arena);
+	}), arena_bytes_used([&] (rejson::Arena * arena) {
+		return rejson::Array(arena, values.size());
+	}));
+	const std::vector<rejson::KeyValuePair> members { { "a", 1 }, { "b", 2 } };
+	EXPECT_EQ(arena_bytes_used([&] (rejson::Arena * arena) {
+		return rejson::Object(members.begin(), members.end(), arena);
+	}), arena_bytes_used([&] (rejson::Arena * arena) {
+		return rejson::Object(arena, members.size());
+	}));
+	rejson::Arena arena;
+	const auto & root = rejson::parse("[[1, 2], {\"a\": 3}]", arena);
+	EXPECT_EQ(root.as_array().capacity(), 2);
+	ASSERT_EQ(root.as_array()[1].as_object().capacity(), 1);
+}
+
+TEST(DocumentTests, ParseDocumentWorks) {
+	const auto document = rejson::parse_document("{ \"foo\": { \"bar\": 123 } }");
+	const auto & foo = document.root().as_object().at("foo");
+	ASSERT_EQ(foo.as_object().at("bar").as_int(), 123);
+}
+
+TEST(DocumentTests, MovedFromDocumentIsNull) {
+	auto document = rejson::parse_document("[1, 2, 3]");
+	const auto other = std::move(document);
+	EXPECT_TRUE(document.root().is_null());
+	ASSERT_EQ(other.root().as_array().size(), 3);
+}
+
+TEST(DocumentTests, ParseDocumentWithInvalidInputThrows) {
+	ASSERT_THROW({
+		rejson::parse_document("[1, 2,");
+	}, rejson::ParseError);
+}
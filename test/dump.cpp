@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <rejson/dump.hpp>
+#include <rejson/parse.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(DumpTests, DumpLiteralsWorks) {
+	EXPECT_EQ(rejson::dump(nullptr), "null");
+	EXPECT_EQ(rejson::dump(true), "true");
+	ASSERT_EQ(rejson::dump(false), "false");
+}
+
+TEST(DumpTests, DumpIntWorks) {
+	EXPECT_EQ(rejson::dump(0), "0");
+	EXPECT_EQ(rejson::dump(7), "7");
+	EXPECT_EQ(rejson::dump(-42), "-42");
+	EXPECT_EQ(rejson::dump(1234567), "1234567");
+	const auto min = std::numeric_limits<rejson::Int>::min();
+	ASSERT_EQ(rejson::dump(min), std::to_string(min));
+}
+
+TEST(DumpTests, DumpRealWorks) {
+	EXPECT_EQ(rejson::dump(0.0), "0.0");
+	EXPECT_EQ(rejson::dump(-0.0), "-0.0");
+	EXPECT_EQ(rejson::dump(1.0), "1.0");
+	EXPECT_EQ(rejson::dump(0.1), "0.1");
+	EXPECT_EQ(rejson::dump(-2.5), "-2.5");
+	EXPECT_EQ(rejson::dump(0.0001), "0.0001");
+	EXPECT_EQ(rejson::dump(1.5e-5), "1.5e-5");
+	EXPECT_EQ(rejson::dump(1e21), "1e+21");
+	EXPECT_EQ(rejson::dump(123456789012345.0), "123456789012345.0");
+	EXPECT_EQ(rejson::dump(5e-324), "5e-324");
+	ASSERT_EQ(rejson::dump(1.7976931348623157e308), "1.7976931348623157e+308");
+}
+
+TEST(DumpTests, DumpNonFiniteRealWritesNull) {
+	EXPECT_EQ(rejson::dump(std::numeric_limits<double>::infinity()), "null");
+	ASSERT_EQ(rejson::dump(std::numeric_limits<double>::quiet_NaN()), "null");
+}
+
+TEST(DumpTests, DumpRealRoundTrips) {
+	std::mt19937_64 random { 42 };
+	for (int i = 0; i < 100000; ++i) {
+		const std::uint64_t bits = random();
+		double real;
+		std::memcpy(&real, &bits, sizeof(real));
+		if (!std::isfinite(real))
+			continue;
+		const auto str = rejson::dump(real);
+		ASSERT_EQ(std::strtod(str.c_str(), nullptr), real) << str;
+	}
+}
+
+TEST(DumpTests, DumpRealIsShortest) {
+	EXPECT_EQ(rejson::dump(-8.481620698703041e+18), "-8.48162069870304e+18");
+	std::mt19937_64 random { 7 };
+	for (int i = 0; i < 100000; ++i) {
+		const std::uint64_t bits = random();
+		double real;
+		std::memcpy(&real, &bits, sizeof(real));
+		if (!std::isfinite(real) || real == 0)
+			continue;
+		int precision = 1;
+		char text[32];
+		for (; precision < 17; ++precision) {
+			std::snprintf(text, sizeof(text), "%.*e", precision - 1, real);
+			if (std::strtod(text, nullptr) == real)
+				break;
+		}
+		const auto str = rejson::dump(real);
+		const auto digits_end = str.find('e');
+		int digits = 0, trailing_zeros = 0;
+		bool leading = true;
+		for (std::size_t j = 0; j < std::min(digits_end, str.size()); ++j) {
+			if (str[j] < '0' || str[j] > '9' || (leading && str[j] == '0'))
+				continue;
+			leading = false;
+			++digits;
+			trailing_zeros = str[j] == '0' ? trailing_zeros + 1 : 0;
+		}
+		ASSERT_EQ(digits - trailing_zeros, precision) << str;
+	}
+}
+
+TEST(DumpTests, DumpStringEscapes) {
+	EXPECT_EQ(rejson::dump("plain"), "\"plain\"");
+	EXPECT_EQ(rejson::dump("a\"b\\c/d"), "\"a\\\"b\\\\c/d\"");
+	EXPECT_EQ(rejson::dump("\b\f\n\r\t"), "\"\\b\\f\\n\\r\\t\"");
+	EXPECT_EQ(rejson::dump(std::string("\x01\x1f", 2)), "\"\\u0001\\u001f\"");
+	ASSERT_EQ(rejson::dump("\xc3\xa9"), "\"\xc3\xa9\"");
+}
+
+TEST(DumpTests, DumpLongStringEscapes) {
+	const std::string str = std::string(100, 'x') + "\n" + std::string(100, 'y');
+	ASSERT_EQ(rejson::dump(str), "\"" + std::string(100, 'x') + "\\n"
+	                             + std::string(100, 'y') + "\"");
+}
+
+TEST(DumpTests, DumpCompactWorks) {
+	const auto value = rejson::parse("{ \"foo\" : [ 1, 2.5, \"x\", [], {}, null ] }");
+	ASSERT_EQ(rejson::dump(value), "{\"foo\":[1,2.5,\"x\",[],{},null]}");
+}
+
+TEST(DumpTests, DumpIndentedWorks) {
+	const auto value = rejson::parse("{\"foo\": [1, {\"bar\": true}, []]}");
+	ASSERT_EQ(rejson::dump(value, 2),
+	          "{\n"
+	          "  \"foo\": [\n"
+	          "    1,\n"
+	          "    {\n"
+	          "      \"bar\": true\n"
+	          "    },\n"
+	          "    []\n"
+	          "  ]\n"
+	          "}");
+}
+
+TEST(DumpTests, DumpAppendsToString) {
+	std::string out = "x=";
+	rejson::dump(std::vector<int> { 1, 2 }, out);
+	ASSERT_EQ(out, "x=[1,2]");
+}
+
+TEST(DumpTests, WriteToStreamWorks) {
+	std::vector<std::string> strings(20000, "some string");
+	const rejson::Value value = strings;
+	std::ostringstream os;
+	rejson::write(value, os);
+	ASSERT_EQ(os.str(), rejson::dump(value));
+}
+
+TEST(DumpTests, DumpParsesBack) {
+	const std::string json = "[{\"a\":[\"\\u0000\\\"\",-1,0.5,true]},1e+100]";
+	ASSERT_EQ(rejson::dump(rejson::parse(json)), json);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <rejson/key_table.hpp>
+#include <rejson/parse.hpp>
+#include <rejson/path.hpp>
+#include <rejson/value.hpp>
+
+#include <string>
+
+TEST(KeyTableTests, InternReturnsSameKeyForSameString) {
+	rejson::KeyTable keys;
+	const auto first = keys.intern("timestamp");
+	const auto second = keys.intern(std::string("timestamp"));
+	EXPECT_TRUE(first.is_interned());
+	EXPECT_EQ(first.data(), second.data());
+	EXPECT_NE(keys.intern("value").data(), first.data());
+	ASSERT_EQ(keys.size(), 2);
+}
+
+TEST(KeyTableTests, InternedKeysKeepTheirHash) {
+	rejson::KeyTable keys;
+	const auto key = keys.intern("host");
+	ASSERT_EQ(key.hash(), rejson::String("host").hash());
+}
+
+TEST(KeyTableTests, KeysOfDifferentTablesCompareByContents) {
+	rejson::KeyTable first, second;
+	EXPECT_EQ(first.intern("abc"), second.intern("abc"));
+	EXPECT_NE(first.intern("abc"), second.intern("abd"));
+	ASSERT_EQ(first.intern("abc"), rejson::String("abc"));
+}
+
+TEST(KeyTableTests, ChangingCopyOfKeyLeavesTableAlone) {
+	rejson::KeyTable keys;
+	rejson::String copy = keys.intern("abc");
+	copy += "def";
+	EXPECT_FALSE(copy.is_interned());
+	EXPECT_EQ(copy, "abcdef");
+	copy.clear();
+	ASSERT_EQ(keys.intern("abc"), "abc");
+}
+
+TEST(KeyTableTests, ParseInternsObjectKeys) {
+	rejson::KeyTable keys;
+	const auto first = rejson::parse("{ \"id\": 1, \"name\": \"a\" }", keys);
+	const auto second = rejson::parse("[{ \"id\": 2 }]", keys);
+	EXPECT_EQ(keys.size(), 2);
+	const auto & id = second.as_array()[0].as_object().begin()->first;
+	EXPECT_TRUE(id.is_interned());
+	ASSERT_EQ(id.data(), first.as_object().begin()->first.data());
+}
+
+TEST(KeyTableTests, PathWithKeyTableFindsInternedKeys) {
+	rejson::KeyTable keys;
+	std::string json = "{ \"outer\": {";
+	for (int i = 0; i < 40; ++i)
+		json += "\"k" + std::to_string(i) + "\": " + std::to_string(i) + ",";
+	json += "\"last\": true } }";
+	const auto root = rejson::parse(json, keys);
+	const rejson::Path path { "outer.k33", keys };
+	EXPECT_EQ(rejson::get(root, path)->as_int(), 33);
+	EXPECT_EQ(rejson::get(root, rejson::Path { "outer.k33" })->as_int(), 33);
+	ASSERT_EQ(rejson::get(root, rejson::Path { "outer.k99", keys }), nullptr);
+}
+
+// The bytes before the characters of the second key end the first one,
+// where a heap string would keep its allocator.
+TEST(KeyTableTests, DroppingCopiesOfKeysLeavesTableAlone) {
+	rejson::KeyTable keys;
+	std::string first(23, '\0');
+	first[0] = 'k';
+	keys.intern(first);
+	keys.intern("zz");
+	EXPECT_EQ(keys.intern(first), rejson::String(first.data(), first.size()));
+	ASSERT_EQ(keys.intern("zz"), "zz");
+}
+
+TEST(KeyTableTests, AppendingToCopyOfLongKeyLeavesTableAlone) {
+	rejson::KeyTable keys;
+	rejson::String copy = keys.intern("a key longer than the inline capacity");
+	copy += "!";
+	EXPECT_FALSE(copy.is_interned());
+	EXPECT_EQ(copy, "a key longer than the inline capacity!");
+	ASSERT_EQ(keys.intern("a key longer than the inline capacity"),
+	          "a key longer than the inline capacity");
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <rejson/error.hpp>
+#include <rejson/ndjson.hpp>
+
+#include <string>
+#include <vector>
+
+TEST(NdjsonTests, ParseNdjsonWorks) {
+	const auto values = rejson::parse_ndjson("{\"a\": 1}\n[2, 3]\n\"four\"\n5.5");
+	ASSERT_EQ(values.size(), 4);
+	EXPECT_EQ(values[0].as_object().at("a").as_int(), 1);
+	EXPECT_EQ(values[1].as_array().size(), 2);
+	EXPECT_EQ(values[2].as_string(), "four");
+	ASSERT_EQ(values[3].as_real(), 5.5);
+}
+
+TEST(NdjsonTests, ParseNdjsonSkipsBlankLines) {
+	const auto values = rejson::parse_ndjson("\n1\r\n\n  \n2\r\n");
+	ASSERT_EQ(values.size(), 2);
+	EXPECT_EQ(values[0].as_int(), 1);
+	ASSERT_EQ(values[1].as_int(), 2);
+}
+
+TEST(NdjsonTests, ParseNdjsonHandlesEscapedQuotes) {
+	const auto values = rejson::parse_ndjson("\"a\\\"\\n\"\n\"\\\\\"\n3");
+	ASSERT_EQ(values.size(), 3);
+	EXPECT_EQ(values[0].as_string(), "a\"\n");
+	EXPECT_EQ(values[1].as_string(), "\\");
+	ASSERT_EQ(values[2].as_int(), 3);
+}
+
+TEST(NdjsonTests, NewlineInsideStringEndsRecord) {
+	try {
+		rejson::parse_ndjson("1\n\"a\nb\"\n3");
+		FAIL() << "expected a parse error";
+	} catch (const rejson::ParseError & e) {
+		ASSERT_EQ(std::string(e.what()), "record 2: unexpected end of input");
+	}
+}
+
+TEST(NdjsonTests, RecordIsNotParsedPastItsLine) {
+	try {
+		rejson::parse_ndjson("[1,\n,2]\n3");
+		FAIL() << "expected a parse error";
+	} catch (const rejson::ParseError & e) {
+		ASSERT_EQ(std::string(e.what()), "record 1: unexpected end of input");
+	}
+}
+
+TEST(NdjsonTests, ValueSpanningLinesThrows) {
+	ASSERT_THROW(rejson::parse_ndjson("[1,\n2]"), rejson::ParseError);
+	ASSERT_THROW(rejson::parse_ndjson("1 2\n"), rejson::ParseError);
+}
+
+TEST(NdjsonTests, ParseNdjsonInParallelKeepsOrder) {
+	std::string json;
+	for (int i = 0; i < 100000; ++i)
+		json += "{\"id\": " + std::to_string(i) + ", \"name\": \"record\"}\n";
+	const auto values = rejson::parse_ndjson(json, 4);
+	ASSERT_EQ(values.size(), 100000);
+	for (int i = 0; i < 100000; ++i)
+		ASSERT_EQ(values[i].as_object().at("id").as_int(), i);
+}
+
+TEST(NdjsonTests, CallbackGetsValuesBeforeError) {
+	std::string json;
+	for (int i = 0; i < 50000; ++i)
+		json += std::to_string(i) + "\n";
+	json += "[\n";
+	for (int i = 0; i < 50000; ++i)
+		json += std::to_string(i) + "\n";
+	std::vector<int> ints;
+	EXPECT_THROW(rejson::parse_ndjson(json, [&](rejson::Value value) {
+		ints.push_back(value.as_int());
+	}, 4), rejson::ParseError);
+	ASSERT_EQ(ints.size(), 50000);
+	ASSERT_EQ(ints.back(), 49999);
+}
@@ -1,9 +1,31 @@
 #include <gtest/gtest.h>
+#include <rejson/arena.hpp>
 #include <rejson/parse.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iterator>
+#include <list>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
 
 TEST(ParseTests, ParseNullWorks) {
 	const auto value = rejson::parse("null");
@@ -178,6 +200,14 @@ TEST(ParseTests, ParseObjectWorks) {
 	ASSERT_EQ(foo.as_int(), 123);
 }
 
+TEST(ParseTests, ParseObjectKeepsFirstOfDuplicateKeys) {
+	const auto value = rejson::parse("{ \"b\": 1, \"a\": 2, \"b\": 3 }");
+	const auto & object = value.as_object();
+	EXPECT_EQ(object.size(), 2);
+	EXPECT_EQ(object.begin()->first, "b");
+	ASSERT_EQ(object.at("b").as_int(), 1);
+}
+
 TEST(ParseTests, ParseEmptyObjectWorks) {
 	const auto value = rejson::parse("{}");
 	ASSERT_EQ(value.as_object().size(), 0);
@@ -240,3 +270,490 @@ TEST(ParseTests, ParseObjectWithValueAloneThrows) {
 		rejson::parse("{ 123 }");
 	}, rejson::ParseError);
 }
+
+TEST(ParseTests, ParseInt64Works) {
+	EXPECT_EQ(rejson::parse("9223372036854775807").as_int(), INT64_MAX);
+	EXPECT_EQ(rejson::parse("-9223372036854775808").as_int(), INT64_MIN);
+	EXPECT_EQ(rejson::parse("1234567890123456").as_int(), 1234567890123456);
+	const std::string json = "-1234567890123456789";
+	ASSERT_EQ(rejson::parse(json.begin(), json.end()).as_int(), -1234567890123456789);
+}
+
+TEST(ParseTests, ParseIntOverflowGivesReal) {
+	for (const char * json : {
+		"9223372036854775808", "-9223372036854775809", "18446744073709551615",
+		"18446744073709551616", "123456789012345678901234567890"
+	}) {
+		EXPECT_EQ(rejson::parse(json).as_real(), std::strtod(json, nullptr)) << json;
+		const std::string str = json;
+		EXPECT_EQ(rejson::parse(str.begin(), str.end()).as_real(),
+		          std::strtod(json, nullptr)) << json;
+	}
+}
+
+TEST(ParseTests, ParseArrayOfLongIntsWorks) {
+	const auto value = rejson::parse("[12345678,123456789012,1,12345678901234567]");
+	const auto & array = value.as_array();
+	EXPECT_EQ(array[0].as_int(), 12345678);
+	EXPECT_EQ(array[1].as_int(), 123456789012);
+	EXPECT_EQ(array[2].as_int(), 1);
+	ASSERT_EQ(array[3].as_int(), 12345678901234567);
+}
+
+TEST(ParseTests, ParseRealIsCorrectlyRounded) {
+	for (const char * json : {
+		"1e23", "0.1", "0.3", "8.41e21", "5e-324", "2.2250738585072011e-308",
+		"2.2250738585072014e-308", "1.7976931348623157e308", "9007199254740993.0",
+		"3.14159265358979323846264338327950288", "123456789012345678901234567890e-10",
+		"12e30", "4.35679e-100", "0.000000000000000000000000000001e30",
+		"7.2057594037927933e16", "1e-400", "1e400", "-0.0"
+	}) {
+		EXPECT_EQ(rejson::parse(json).as_real(), std::strtod(json, nullptr)) << json;
+		const std::string str = json;
+		EXPECT_EQ(rejson::parse(str.begin(), str.end()).as_real(),
+		          std::strtod(json, nullptr)) << json;
+	}
+}
+
+TEST(ParseTests, ParseRandomRealsIsCorrectlyRounded) {
+	std::mt19937_64 random { 7 };
+	char buffer[32];
+	for (int i = 0; i < 100000; ++i) {
+		const std::uint64_t bits = random();
+		double real;
+		std::memcpy(&real, &bits, sizeof(real));
+		if (!std::isfinite(real))
+			continue;
+		std::snprintf(buffer, sizeof(buffer), "%.*e", i % 17, real);
+		ASSERT_EQ(rejson::parse(buffer).as_real(), std::strtod(buffer, nullptr))
+			<< buffer;
+	}
+}
+
+TEST(ParseTests, ParseRealWithHugeExponentWorks) {
+	EXPECT_EQ(rejson::parse("1e99999999999999999999").as_real(), HUGE_VAL);
+	ASSERT_EQ(rejson::parse("1e-99999999999999999999").as_real(), 0.0);
+}
+
+TEST(ParseTests, ParseArrayOfRealsWorks) {
+	const auto value = rejson::parse("[1.5, -2.25]");
+	const auto & array = value.as_array();
+	EXPECT_EQ(array.size(), 2);
+	EXPECT_EQ(array[0].as_real(), 1.5);
+	ASSERT_EQ(array[1].as_real(), -2.25);
+}
+
+TEST(ParseTests, ParseSurrogatePairStringWorks) {
+	const auto value = rejson::parse("\"\\ud83d\\ude00\"");
+	ASSERT_EQ(value.as_string(), "\xf0\x9f\x98\x80");
+}
+
+TEST(ParseTests, ParseTruncatedInputThrows) {
+	const char json[] = "[1, 2, 3]";
+	ASSERT_THROW({
+		rejson::parse(rejson::detail::string_view { json, 6 });
+	}, rejson::ParseError);
+}
+
+TEST(ParseTests, ParseTruncatedLiteralThrows) {
+	const char json[] = "true";
+	ASSERT_THROW({
+		rejson::parse(rejson::detail::string_view { json, 3 });
+	}, rejson::ParseError);
+}
+
+TEST(ParseTests, ParseLargeDocumentWorks) {
+	std::string json = "[";
+	for (int i = 0; i < 1000; ++i)
+		json += "\"abcdefghij\",";
+	json.back() = ']';
+	const auto value = rejson::parse(json);
+	const auto & array = value.as_array();
+	EXPECT_EQ(array.size(), 1000);
+	ASSERT_EQ(array.back().as_string(), "abcdefghij");
+}
+
+TEST(ParseTests, ParseFromIteratorsWorks) {
+	const std::list<char> json { '[', '1', ',', '2', ']' };
+	const auto value = rejson::parse(json.begin(), json.end());
+	ASSERT_EQ(value.as_array().size(), 2);
+}
+
+TEST(ParseTests, ParseIndentedDocumentWorks) {
+	const auto value = rejson::parse(
+		"{\n"
+		"                                        \"foo\": [\n"
+		"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t1,\r\n"
+		"                                        2\n"
+		"                                    ]\n"
+		"}\n");
+	ASSERT_EQ(value.as_object().at("foo").as_array().size(), 2);
+}
+
+TEST(ParseTests, ParseVerticalTabAsWhitespaceThrows) {
+	ASSERT_THROW({
+		rejson::parse("[\v1]");
+	}, rejson::ParseError);
+}
+
+TEST(ParseTests, ParseLongEscapedStringWorks) {
+	const std::string text(100, 'x');
+	const auto value = rejson::parse(
+		"\"" + text + "\\n" + text + "\\\"" + text + "\"");
+	ASSERT_EQ(value.as_string(), text + "\n" + text + "\"" + text);
+}
+
+TEST(ParseTests, ParseLongUnescapedStringThrows) {
+	const std::string text(100, 'x');
+	ASSERT_THROW({
+		rejson::parse("\"" + text + "\n" + text + "\"");
+	}, rejson::ParseError);
+}
+
+TEST(ParseTests, ParseNonAsciiStringWorks) {
+	const auto value = rejson::parse("\"\xc3\xa9t\xc3\xa9 \x7f\"");
+	ASSERT_EQ(value.as_string(), "\xc3\xa9t\xc3\xa9 \x7f");
+}
+
+TEST(ParseTests, ParseThreeByteCodePointStringWorks) {
+	const auto value = rejson::parse("\"\\u4e2d\\u00e9\"");
+	ASSERT_EQ(value.as_string(), "\xe4\xb8\xad\xc3\xa9");
+}
+
+TEST(ParseTests, ParseStringFromIteratorsWorks) {
+	const std::string json = "\"abc\\tdef\\ud83d\\ude00\\u4e2dghi\"";
+	const auto value = rejson::parse(json.begin(), json.end());
+	ASSERT_EQ(value.as_string(), "abc\tdef\xf0\x9f\x98\x80\xe4\xb8\xadghi");
+}
+
+TEST(ParseTests, ParseStringFromStreamWorks) {
+	std::istringstream is { "\"abc\\u00e9def\"" };
+	const auto value = rejson::parse(is);
+	ASSERT_EQ(value.as_string(), "abc\xc3\xa9" "def");
+}
+
+TEST(ParseTests, ParseStreamKeepsSpacesInStrings) {
+	std::istringstream is { "{ \"a b\" : [ \"c  d\", 1 ] }" };
+	const auto value = rejson::parse(is);
+	ASSERT_EQ(value.as_object().at("a b").as_array()[0].as_string(), "c  d");
+}
+
+TEST(ParseTests, ParseStreamLeavesRestOfInput) {
+	std::istringstream is { "[1, 2] {\"a\": 3} 4" };
+	EXPECT_EQ(rejson::parse(is).as_array().size(), 2);
+	EXPECT_EQ(rejson::parse(is).as_object().at("a").as_int(), 3);
+	EXPECT_EQ(rejson::parse(is).as_int(), 4);
+	EXPECT_TRUE(is.eof());
+	ASSERT_THROW(rejson::parse(is), rejson::ParseError);
+}
+
+// Exposes a few bytes of the input at a time, as a pipe might.
+class TrickleBuffer : public std::streambuf
+{
+public:
+	explicit TrickleBuffer(std::string data)
+		: data_ (std::move(data)), pos_ { 0 } {}
+
+protected:
+	int_type underflow() override
+	{
+		if (pos_ == data_.size())
+			return traits_type::eof();
+		const auto size = std::min<std::size_t>(3, data_.size() - pos_);
+		char * const window = &data_[pos_];
+		setg(window, window, window + size);
+		pos_ += size;
+		return traits_type::to_int_type(*window);
+	}
+
+private:
+	std::string data_;
+	std::size_t pos_;
+};
+
+TEST(ParseTests, ParseStreamReadsOnlyWhatIsAvailable) {
+	TrickleBuffer buffer { "{\"a\": [1, 2]} [\"b\", 3] " };
+	std::istream is { &buffer };
+	EXPECT_EQ(rejson::parse(is).as_object().at("a").as_array().size(), 2);
+	EXPECT_TRUE(is.good());
+	EXPECT_EQ(rejson::parse(is).as_array()[0].as_string(), "b");
+	ASSERT_TRUE(is.good());
+}
+
+// Shows no get area, refuses putback, and stands for a pipe whose writer
+// is still open once the characters written so far are read.
+class UnbufferedPipe : public std::streambuf
+{
+public:
+	UnbufferedPipe(std::string data, std::size_t written)
+		: data_ (std::move(data)), pos_ { 0 }, written_ { written } {}
+
+	void write(std::size_t size)
+	{
+		written_ += size;
+	}
+
+protected:
+	int_type underflow() override
+	{
+		if (pos_ == written_)
+			throw std::runtime_error("read would block");
+		if (pos_ == data_.size())
+			return traits_type::eof();
+		return traits_type::to_int_type(data_[pos_]);
+	}
+
+	int_type uflow() override
+	{
+		const auto chr = underflow();
+		pos_ += !traits_type::eq_int_type(chr, traits_type::eof());
+		return chr;
+	}
+
+private:
+	std::string data_;
+	std::size_t pos_;
+	std::size_t written_;
+};
+
+TEST(ParseTests, ParseUnbufferedStreamStopsAtValue) {
+	const std::string first = "{\"a\": 1}", second = " {\"b\": 2}";
+	UnbufferedPipe pipe { first + second, first.size() };
+	std::istream is { &pipe };
+	EXPECT_EQ(rejson::parse(is).as_object().at("a").as_int(), 1);
+	EXPECT_TRUE(is.good());
+	pipe.write(second.size() + 1);
+	EXPECT_EQ(rejson::parse(is).as_object().at("b").as_int(), 2);
+	ASSERT_TRUE(is.good());
+}
+
+TEST(ParseTests, ParseStreamReadsLargeInput) {
+	std::string json = "[";
+	for (int i = 0; i < 100000; ++i)
+		json += "\"item " + std::to_string(i) + "\", ";
+	json += "null]";
+	std::istringstream is { json };
+	const auto value = rejson::parse(is);
+	ASSERT_EQ(value.as_array().size(), 100001);
+	ASSERT_EQ(value.as_array()[12345].as_string(), "item 12345");
+}
+
+TEST(ParseTests, ParseWideStreamWorks) {
+	std::wistringstream is { L"[\"a b\", 1]" };
+	const auto value = rejson::parse(is);
+	ASSERT_EQ(value.as_array()[0].as_string(), "a b");
+}
+
+TEST(ParseTests, ParseUtf16Works) {
+	const std::u16string json =
+		u"{\"plain ascii key longer than a block\": [\"café 中 \U0001f600\", 1.5]}";
+	const auto value = rejson::parse(rejson::detail::u16string_view(json));
+	const auto & array = value.as_object().at("plain ascii key longer than a block").as_array();
+	EXPECT_EQ(array[0].as_string(), "caf\xc3\xa9 \xe4\xb8\xad \xf0\x9f\x98\x80");
+	ASSERT_EQ(array[1].as_real(), 1.5);
+}
+
+TEST(ParseTests, ParseUtf32Works) {
+	const std::u32string json = U"[\"é\U0001f600\", \"abcdefghijklmnopqrstuvwxyz\"]";
+	const auto value = rejson::parse(rejson::detail::u32string_view(json));
+	EXPECT_EQ(value.as_array()[0].as_string(), "\xc3\xa9\xf0\x9f\x98\x80");
+	ASSERT_EQ(value.as_array()[1].as_string(), "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST(ParseTests, ParseWideStringWorks) {
+	const std::wstring json = L"[\"é\", true]";
+	const auto value = rejson::parse(rejson::detail::wstring_view(json));
+	ASSERT_EQ(value.as_array()[0].as_string(), "\xc3\xa9");
+}
+
+TEST(ParseTests, ParseInvalidWideInputThrows) {
+	const std::u16string lone_high = { u'"', 0xd83d, u'"' };
+	const std::u16string lone_low = { u'"', 0xde00, u'"' };
+	const std::u32string surrogate = { U'"', 0xd800, U'"' };
+	const std::u32string too_large = { U'"', 0x110000, U'"' };
+	EXPECT_THROW(rejson::parse(rejson::detail::u16string_view(lone_high)), rejson::ParseError);
+	EXPECT_THROW(rejson::parse(rejson::detail::u16string_view(lone_low)), rejson::ParseError);
+	EXPECT_THROW(rejson::parse(rejson::detail::u32string_view(surrogate)), rejson::ParseError);
+	ASSERT_THROW(rejson::parse(rejson::detail::u32string_view(too_large)), rejson::ParseError);
+}
+
+TEST(ParseTests, ParseObjectFromIteratorsWorks) {
+	const std::string json = "{\"foo\":\"bar\",\"baz\":[1,2]}";
+	const auto value = rejson::parse(json.begin(), json.end());
+	const auto & object = value.as_object();
+	EXPECT_EQ(object.at("foo").as_string(), "bar");
+	ASSERT_EQ(object.at("baz").as_array().size(), 2);
+}
+
+namespace {
+
+struct EventRecorder {
+	std::vector<std::string> events;
+
+	void on_null() { events.push_back("null"); }
+	void on_bool(bool b) { events.push_back(b ? "true" : "false"); }
+	void on_int(rejson::Int i) { events.push_back("int " + std::to_string(i)); }
+	void on_real(rejson::Real r) { events.push_back("real " + std::to_string(r)); }
+	void on_string(rejson::detail::string_view s) { events.push_back("string " + s.to_string()); }
+	void on_key(rejson::detail::string_view k) { events.push_back("key " + k.to_string()); }
+	void on_array_begin() { events.push_back("["); }
+	void on_array_end(std::size_t size) { events.push_back("] " + std::to_string(size)); }
+	void on_object_begin() { events.push_back("{"); }
+	void on_object_end(std::size_t size) { events.push_back("} " + std::to_string(size)); }
+};
+
+const std::vector<std::string> expected_events {
+	"{", "key foo", "[", "int 1", "real 2.500000", "string a\nb", "] 3",
+	"key bar", "{", "} 0", "key baz", "null", "key qux", "true", "} 4"
+};
+
+const char events_json[] =
+	"{\"foo\": [1, 2.5, \"a\\nb\"], \"bar\": {}, \"baz\": null, \"qux\": true}";
+
+}
+
+TEST(ParseTests, ParseWithHandlerReportsEvents) {
+	EventRecorder recorder;
+	rejson::parse(events_json, recorder);
+	ASSERT_EQ(recorder.events, expected_events);
+}
+
+TEST(ParseTests, ParseIteratorsWithHandlerReportsEvents) {
+	EventRecorder recorder;
+	const std::string json = events_json;
+	rejson::parse(json.begin(), json.end(), recorder);
+	ASSERT_EQ(recorder.events, expected_events);
+}
+
+TEST(ParseTests, ParseWithValueBuilderWorks) {
+	rejson::ValueBuilder builder;
+	rejson::parse(events_json, builder);
+	const auto value = builder.take();
+	ASSERT_EQ(value.as_object().size(), 4);
+}
+
+TEST(ParseTests, ParseIndexedReportsEvents) {
+	EventRecorder recorder;
+	rejson::parse_indexed(events_json, recorder);
+	ASSERT_EQ(recorder.events, expected_events);
+}
+
+TEST(ParseTests, StructuralIndexSkipsStringContents) {
+	const rejson::detail::PaddedBuffer buffer { R"({"a\"]": [1, "\\", true]})" };
+	const rejson::detail::StructuralIndex index { buffer };
+	const std::vector<std::uint32_t> offsets(index.begin(), index.end());
+	ASSERT_EQ(offsets, (std::vector<std::uint32_t> { 0, 1, 7, 9, 10, 11, 13, 17, 19, 23, 24 }));
+}
+
+TEST(ParseTests, ParseIndexedMatchesParse) {
+	// Runs of backslashes of every length, ending on both sides of the
+	// 64-byte blocks of the index.
+	std::string json = "[";
+	for (std::size_t i = 0; i < 200; ++i) {
+		json += "{\"key\": \"" + std::string(i % 7 * 2, '\\') + "\\\"\", \"n\": -"
+		      + std::to_string(i) + ".5e1, \"list\": [true, null, \"\\u00e9\"]}, ";
+		json += std::string(i % 5, ' ');
+	}
+	json += "{}]";
+	EventRecorder expected, recorder;
+	rejson::parse(json, expected);
+	rejson::parse_indexed(json, recorder);
+	ASSERT_EQ(recorder.events, expected.events);
+}
+
+TEST(ParseTests, ParseIndexedRejectsWhatParseRejects) {
+	for (const char * json : { "[1 2]", "[1,]", "{\"a\" 1}", "{\"a\": 1,}", "truex",
+	                           "[true\"x\"]", "[\"a]", "{\"a\":", "", "[01]", "{1: 2}" }) {
+		rejson::ValueBuilder builder;
+		std::string expected, message;
+		try {
+			rejson::parse(json, builder);
+		} catch (const rejson::ParseError & e) {
+			expected = e.what();
+		}
+		try {
+			rejson::parse_indexed(json, builder);
+		} catch (const rejson::ParseError & e) {
+			message = e.what();
+		}
+		EXPECT_EQ(message, expected) << json;
+	}
+}
+
+namespace {
+
+std::string write_temp_file(const std::string & name, const std::string & contents)
+{
+	const auto path = ::testing::TempDir() + name;
+	std::ofstream(path, std::ios::binary) << contents;
+	return path;
+}
+
+}
+
+TEST(ParseTests, ParseFileWorks) {
+	// Ending the file on a page boundary leaves all padding to the pages
+	// mapped after it.
+	const std::string json = "[\"a\", " + std::string(4096 - 10, ' ') + "1.5]";
+	const auto path = write_temp_file("rejson_page.json", json);
+	const auto value = rejson::parse_file(path);
+	ASSERT_EQ(value.as_array().size(), 2);
+	EXPECT_EQ(value.as_array()[0].as_string(), "a");
+	EXPECT_EQ(value.as_array()[1].as_real(), 1.5);
+	rejson::Arena arena;
+	const auto & in_arena = rejson::parse_file(path, arena, rejson::FileAccess::Normal);
+	EXPECT_EQ(in_arena.as_array().size(), 2);
+	EventRecorder recorder;
+	rejson::parse_file(write_temp_file("rejson_events.json", events_json), recorder,
+	                   rejson::FileAccess::WillNeed);
+	ASSERT_EQ(recorder.events, expected_events);
+}
+
+TEST(ParseTests, ParseFileReportsErrors) {
+	EXPECT_THROW(rejson::parse_file(write_temp_file("rejson_empty.json", "")),
+	             rejson::ParseError);
+	EXPECT_THROW(rejson::parse_file(write_temp_file("rejson_cut.json", "[1, ")),
+	             rejson::ParseError);
+	ASSERT_THROW(rejson::parse_file(::testing::TempDir() + "rejson_missing.json"),
+	             std::system_error);
+}
+
+#if !defined(_WIN32)
+TEST(ParseTests, ParseFileReadsPipes) {
+	const auto path = ::testing::TempDir() + "rejson_fifo";
+	::unlink(path.c_str());
+	ASSERT_EQ(::mkfifo(path.c_str(), 0600), 0);
+	std::string json = "[";
+	for (int i = 0; i < 100000; ++i)
+		json += std::to_string(i) + ", ";
+	json += "0]";
+	std::thread writer { [&] { std::ofstream(path, std::ios::binary) << json; } };
+	const auto value = rejson::parse_file(path);
+	writer.join();
+	::unlink(path.c_str());
+	ASSERT_EQ(value.as_array().size(), 100001);
+	ASSERT_EQ(value.as_array()[99999].as_int(), 99999);
+}
+#endif
+
+TEST(ParseTests, IsValidUtf8Works) {
+	EXPECT_TRUE(rejson::is_valid_utf8(""));
+	EXPECT_TRUE(rejson::is_valid_utf8("plain ascii text that spans several blocks of input"));
+	EXPECT_TRUE(rejson::is_valid_utf8("caf\xc3\xa9 \xe4\xb8\xad \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf"));
+	EXPECT_FALSE(rejson::is_valid_utf8("\xc0\xaf"));
+	EXPECT_FALSE(rejson::is_valid_utf8("\xe0\x80\xaf"));
+	EXPECT_FALSE(rejson::is_valid_utf8("\xed\xa0\x80"));
+	EXPECT_FALSE(rejson::is_valid_utf8("\xf4\x90\x80\x80"));
+	EXPECT_FALSE(rejson::is_valid_utf8("\xf8\x88\x80\x80\x80"));
+	EXPECT_FALSE(rejson::is_valid_utf8("ascii before a cut sequence \xe4\xb8"));
+	ASSERT_FALSE(rejson::is_valid_utf8("\x80 stray continuation byte"));
+}
+
+TEST(ParseTests, ParseStrictUtf8RejectsInvalidStrings) {
+	const auto value = rejson::parse("{\"caf\xc3\xa9\": \"\\u00e9\"}", rejson::Utf8Check::Strict);
+	EXPECT_EQ(value.as_object().at("caf\xc3\xa9").as_string(), "\xc3\xa9");
+	EXPECT_NO_THROW(rejson::parse("[\"\xff\"]"));
+	EXPECT_THROW(rejson::parse("[\"\xff\"]", rejson::Utf8Check::Strict), rejson::ParseError);
+	ASSERT_THROW(rejson::parse("{\"\xe4\xb8\": 1}", rejson::Utf8Check::Strict),
+	             rejson::ParseError);
+}
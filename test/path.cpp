@@ -1,7 +1,18 @@
 #include <gtest/gtest.h>
+#include <rejson/dump.hpp>
+#include <rejson/parse.hpp>
 #include <rejson/path.hpp>
+#include <rejson/path_set.hpp>
+#include <rejson/static_path.hpp>
 #include <rejson/value.hpp>
 
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 TEST(PathTests, GetFromObjectByDotWorks) {
 	const rejson::Value root = rejson::Object {
 		rejson::KeyValuePair { "foo", rejson::Object {
@@ -83,3 +94,224 @@ TEST(PathTests, GetValueOrFromTemporaryWorks) {
 	}, "foo.bar", 123);
 	ASSERT_EQ(value.as_int(), 123);
 }
+
+TEST(PathTests, PathCompilesIntoSegments) {
+	const rejson::Path path { "foo[bar][2].baz" };
+	const auto & segments = path.segments();
+	ASSERT_EQ(segments.size(), 4);
+	EXPECT_EQ(segments[1].key, "bar");
+	EXPECT_EQ(segments[1].hash, rejson::String("bar").hash());
+	EXPECT_EQ(segments[2].kind, rejson::Path::SegmentKind::Index);
+	ASSERT_EQ(segments[2].index, 2);
+}
+
+TEST(PathTests, GetFromLargeObjectWorks) {
+	rejson::Object object;
+	for (int i = 0; i < 50; ++i)
+		object.emplace("key" + std::to_string(i), i);
+	const rejson::Value root = std::move(object);
+	EXPECT_EQ(rejson::get(root, "key42")->as_int(), 42);
+	ASSERT_TRUE(rejson::get(root, "key50") == nullptr);
+}
+
+TEST(PathTests, CachedPathIsCompiledOnce) {
+	const auto first = rejson::Path::cached("cached.path[1]");
+	const auto second = rejson::Path::cached(std::string("cached.path[1]"));
+	EXPECT_EQ(first, second);
+	ASSERT_EQ(first->segments().size(), 3);
+}
+
+TEST(PathTests, CachedPathOutlivesEviction) {
+	const auto path = rejson::Path::cached("evicted");
+	for (int i = 0; i < 5000; ++i)
+		rejson::Path::cached("filler" + std::to_string(i));
+	const rejson::Value root = rejson::Object { { "evicted", 1 } };
+	ASSERT_EQ(path->resolve(root)->as_int(), 1);
+}
+
+TEST(PathTests, CachedPathWorksFromManyThreads) {
+	const rejson::Value root = rejson::Object { { "a", rejson::Array { 1, 2, 3 } } };
+	std::vector<std::thread> threads;
+	std::atomic<int> found { 0 };
+	for (int t = 0; t < 8; ++t) {
+		threads.emplace_back([&] {
+			for (int i = 0; i < 1000; ++i) {
+				if (rejson::get(root, "a[2]")->as_int() == 3)
+					++found;
+				rejson::Path::cached("a[" + std::to_string(i % 100) + "]");
+			}
+		});
+	}
+	for (auto & thread : threads)
+		thread.join();
+	ASSERT_EQ(found, 8000);
+}
+
+constexpr auto static_path = REJSON_PATH("foo[bar][12].baz");
+static_assert(static_path.size() == 4, "static path has four segments");
+static_assert(static_path[2].is_index && static_path[2].index == 12,
+              "bracketed digits are an index");
+
+TEST(PathTests, GetWithStaticPathWorks) {
+	const rejson::Value root = rejson::Object {
+		rejson::KeyValuePair { "foo", rejson::Array { 1, rejson::Object {
+			rejson::KeyValuePair { "bar", 123 }
+		} } }
+	};
+	EXPECT_EQ(rejson::get(root, REJSON_PATH("foo[1].bar"))->as_int(), 123);
+	EXPECT_TRUE(rejson::get(root, REJSON_PATH("foo[2]")) == nullptr);
+	ASSERT_EQ(rejson::get_value_or(root, REJSON_PATH("foo[1].baz"), 456).as_int(), 456);
+}
+
+namespace {
+
+const rejson::Value records = rejson::Object {
+	rejson::KeyValuePair { "records", rejson::Array {
+		rejson::Object { { "id", 1 }, { "tags", rejson::Array { "a", "b" } } },
+		rejson::Object { { "id", 2 }, { "tags", rejson::Array {} } },
+		rejson::Object { { "id", 3 }, { "child", rejson::Object { { "id", 4 } } } },
+		"not a record"
+	} }
+};
+
+std::vector<rejson::Int> resolve_ints(const rejson::Path & path)
+{
+	std::vector<rejson::Int> ints;
+	path.resolve_all(records, [&ints] (const rejson::Value & value) {
+		ints.push_back(value.as_int());
+	});
+	return ints;
+}
+
+}
+
+TEST(PathTests, WildcardMatchesEveryElement) {
+	EXPECT_EQ(resolve_ints("records[*].id"), (std::vector<rejson::Int> { 1, 2, 3 }));
+	ASSERT_EQ(resolve_ints("records.*.id"), (std::vector<rejson::Int> { 1, 2, 3 }));
+}
+
+TEST(PathTests, SliceMatchesRangeOfElements) {
+	EXPECT_EQ(resolve_ints("records[1:3].id"), (std::vector<rejson::Int> { 2, 3 }));
+	EXPECT_EQ(resolve_ints("records[:2].id"), (std::vector<rejson::Int> { 1, 2 }));
+	EXPECT_EQ(resolve_ints("records[-2:].id"), (std::vector<rejson::Int> { 3 }));
+	ASSERT_TRUE(resolve_ints("records[5:].id").empty());
+}
+
+TEST(PathTests, RecursiveDescentMatchesAtAnyDepth) {
+	EXPECT_EQ(resolve_ints("..id"), (std::vector<rejson::Int> { 1, 2, 3, 4 }));
+	ASSERT_EQ(resolve_ints("records..child.id"), (std::vector<rejson::Int> { 4 }));
+}
+
+TEST(PathTests, ResolveAllAppendsToVector) {
+	std::vector<const rejson::Value *> out;
+	rejson::Path("records[*].tags[*]").resolve_all(records, out);
+	ASSERT_EQ(out.size(), 2);
+	EXPECT_EQ(out[0]->as_string(), "a");
+	ASSERT_EQ(out[1]->as_string(), "b");
+}
+
+TEST(PathTests, ResolveReturnsFirstMatch) {
+	EXPECT_EQ(rejson::get(records, "records[*].child.id")->as_int(), 4);
+	ASSERT_TRUE(rejson::get(records, "records[*].missing") == nullptr);
+}
+
+TEST(PathTests, InvalidMultiMatchPathsThrow) {
+	EXPECT_THROW(rejson::Path("records.."), std::invalid_argument);
+	EXPECT_THROW(rejson::Path("records[1:x]"), std::invalid_argument);
+	ASSERT_THROW(rejson::Path("records[]"), std::invalid_argument);
+}
+
+TEST(PathTests, PathSetResolvesEveryPath) {
+	rejson::PathSet paths;
+	const auto id = paths.add("records[2].id");
+	const auto child = paths.add("records[2].child.id");
+	const auto missing = paths.add("records[2].missing");
+	const auto tag = paths.add("records[*].tags[1]");
+	const auto deep = paths.add("..child.id");
+	const auto root = paths.add("");
+	EXPECT_EQ(paths.size(), 6);
+	std::vector<const rejson::Value *> results;
+	paths.resolve(records, results);
+	ASSERT_EQ(results.size(), 6);
+	EXPECT_EQ(results[id]->as_int(), 3);
+	EXPECT_EQ(results[child]->as_int(), 4);
+	EXPECT_TRUE(results[missing] == nullptr);
+	EXPECT_EQ(results[tag]->as_string(), "b");
+	EXPECT_EQ(results[deep]->as_int(), 4);
+	ASSERT_EQ(results[root], &records);
+}
+
+TEST(PathTests, PathSetSkipsValuesOfWrongType) {
+	rejson::PathSet paths;
+	paths.add("records.id");
+	std::vector<const rejson::Value *> results;
+	paths.resolve(records, results);
+	ASSERT_TRUE(results[0] == nullptr);
+}
+
+namespace {
+
+const char * const selected_json = R"({
+	"meta": { "count": 3, "note": "skip \"me\" é" },
+	"records": [
+		{ "id": 1, "tags": ["a", "b"], "blob": [[1, 2], { "x": null }] },
+		{ "id": 2, "tags": [], "blob": 1.5e3 },
+		{ "id": 3, "child": { "id": 4 } },
+		"not a record"
+	],
+	"tail": [true, false, -0.25]
+})";
+
+}
+
+TEST(PathTests, ParseSelectedBuildsOnlyReachedValues) {
+	rejson::PathSet paths;
+	const auto id = paths.add("records[1].id");
+	const auto tag = paths.add("records[0].tags[1]");
+	const auto count = paths.add("meta.count");
+	const auto root = rejson::parse_selected(selected_json, paths);
+	std::vector<const rejson::Value *> results;
+	paths.resolve(root, results);
+	EXPECT_EQ(results[id]->as_int(), 2);
+	EXPECT_EQ(results[tag]->as_string(), "b");
+	EXPECT_EQ(results[count]->as_int(), 3);
+	EXPECT_EQ(root.as_object().size(), 2);
+	EXPECT_EQ(root.as_object().at("meta").as_object().size(), 1);
+	EXPECT_EQ(root.as_object().at("records").as_array().size(), 2);
+	ASSERT_EQ(root.as_object().at("records").as_array()[0].as_object().size(), 1);
+}
+
+TEST(PathTests, ParseSelectedMatchesFullParse) {
+	const auto full = rejson::parse(selected_json);
+	for (auto mode : { rejson::SkipMode::Validate, rejson::SkipMode::Unchecked }) {
+		rejson::PathSet paths;
+		for (auto path : { "records[*].id", "records[1:].tags", "records..id",
+		                   "tail[-1]", "meta", "records[2].child", "missing.key" })
+			paths.add(path);
+		const auto root = rejson::parse_selected(selected_json, paths, mode);
+		std::vector<const rejson::Value *> expected, results;
+		paths.resolve(full, expected);
+		paths.resolve(root, results);
+		for (std::size_t i = 0; i < paths.size(); ++i) {
+			if (!expected[i])
+				EXPECT_TRUE(results[i] == nullptr);
+			else
+				EXPECT_EQ(rejson::dump(*results[i]), rejson::dump(*expected[i]));
+		}
+	}
+}
+
+TEST(PathTests, ParseSelectedValidatesSkippedValues) {
+	rejson::PathSet paths;
+	paths.add("a");
+	EXPECT_THROW(rejson::parse_selected(R"({"a": 1, "b": [1, 2,]})", paths),
+	             rejson::ParseError);
+	EXPECT_THROW(rejson::parse_selected(R"({"a": 1, "b": 01})", paths),
+	             rejson::ParseError);
+	EXPECT_NO_THROW(rejson::parse_selected(R"({"a": 1, "b": [1, 2,]})", paths,
+	                                       rejson::SkipMode::Unchecked));
+	EXPECT_THROW(rejson::parse_selected(R"({"a": 1, "b": [1, "2)", paths,
+	                                    rejson::SkipMode::Unchecked),
+	             rejson::ParseError);
+	ASSERT_THROW(rejson::parse_selected(R"({"b": 1, "a")", paths), rejson::ParseError);
+}
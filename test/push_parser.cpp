@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <rejson/parse.hpp>
+#include <rejson/push_parser.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char document[] =
+	"{\"foo\": [1, -2.5e1, true, false, null], \"bar\": \"a\\n\\u00e9\\ud83d\\ude00b\","
+	" \"baz\": {\"qux\": []}}";
+
+std::vector<rejson::Value> feed_in_chunks(const std::string & json, std::size_t size)
+{
+	rejson::PushParser parser;
+	std::vector<rejson::Value> values;
+	for (std::size_t i = 0; i < json.size(); i += size) {
+		for (auto && value : parser.feed(json.substr(i, size)))
+			values.push_back(std::move(value));
+	}
+	for (auto && value : parser.finish())
+		values.push_back(std::move(value));
+	return values;
+}
+
+void expect_document(const rejson::Value & value)
+{
+	const auto & object = value.as_object();
+	const auto & foo = object.at("foo").as_array();
+	ASSERT_EQ(foo.size(), 5);
+	EXPECT_EQ(foo[0].as_int(), 1);
+	EXPECT_EQ(foo[1].as_real(), -25.0);
+	EXPECT_EQ(foo[2].as_bool(), true);
+	EXPECT_EQ(foo[3].as_bool(), false);
+	EXPECT_TRUE(foo[4].is_null());
+	EXPECT_EQ(object.at("bar").as_string(), "a\n\xc3\xa9\xf0\x9f\x98\x80" "b");
+	EXPECT_TRUE(object.at("baz").as_object().at("qux").as_array().empty());
+}
+
+}
+
+TEST(PushParserTests, FeedWholeDocumentWorks) {
+	const auto values = feed_in_chunks(document, sizeof(document));
+	ASSERT_EQ(values.size(), 1);
+	expect_document(values[0]);
+}
+
+TEST(PushParserTests, FeedEveryChunkSizeWorks) {
+	for (std::size_t size = 1; size < sizeof(document); ++size) {
+		const auto values = feed_in_chunks(document, size);
+		ASSERT_EQ(values.size(), 1) << "chunk size " << size;
+		expect_document(values[0]);
+	}
+}
+
+TEST(PushParserTests, FeedReturnsValuesWhenComplete) {
+	rejson::PushParser parser;
+	EXPECT_TRUE(parser.feed("[1, 2").empty());
+	const auto values = parser.feed("]  {\"a\"");
+	ASSERT_EQ(values.size(), 1);
+	EXPECT_EQ(values[0].as_array().size(), 2);
+	EXPECT_TRUE(parser.feed(": 1").empty());
+	ASSERT_EQ(parser.feed("}").size(), 1);
+}
+
+TEST(PushParserTests, FeedSeveralDocumentsWorks) {
+	const auto values = feed_in_chunks("1 \"two\"\n[3]\n{}\n4.5", 3);
+	ASSERT_EQ(values.size(), 5);
+	EXPECT_EQ(values[0].as_int(), 1);
+	EXPECT_EQ(values[1].as_string(), "two");
+	EXPECT_EQ(values[2].as_array()[0].as_int(), 3);
+	EXPECT_TRUE(values[3].as_object().empty());
+	ASSERT_EQ(values[4].as_real(), 4.5);
+}
+
+TEST(PushParserTests, FinishCompletesTopLevelNumber) {
+	rejson::PushParser parser;
+	EXPECT_TRUE(parser.feed("12").empty());
+	EXPECT_TRUE(parser.feed("34").empty());
+	const auto values = parser.finish();
+	ASSERT_EQ(values.size(), 1);
+	ASSERT_EQ(values[0].as_int(), 1234);
+}
+
+TEST(PushParserTests, FinishMidDocumentThrows) {
+	rejson::PushParser parser;
+	parser.feed("[1, ");
+	ASSERT_THROW(parser.finish(), rejson::ParseError);
+}
+
+TEST(PushParserTests, InvalidInputThrows) {
+	for (const char * json : { "[1,]", "[,1]", "{\"a\" 1}", "{\"a\":1,}", "nul!",
+	                           "[1 2]", "[01]", "[1.]", "\"\x01\"", "}" }) {
+		rejson::PushParser parser;
+		EXPECT_THROW(parser.feed(json), rejson::ParseError) << json;
+	}
+}
+
+TEST(PushParserTests, InvalidTopLevelNumberThrows) {
+	for (const char * json : { "01", "1.", "-", "1e", "1e+" }) {
+		rejson::PushParser parser;
+		parser.feed(json);
+		EXPECT_THROW(parser.finish(), rejson::ParseError) << json;
+	}
+}
+
+TEST(PushParserTests, NumbersEndWhereBufferEngineStops) {
+	for (const char * json : { "[1-5]", "{\"a\": 1-5}", "[1.5.2]", "[1e5e2]", "[2+3]",
+	                           "[1.-5]", "[1e+-5]", "[-.5]", "[0.e1]" }) {
+		std::string buffer_error, push_error;
+		try {
+			rejson::parse(rejson::detail::string_view { json });
+		} catch (const rejson::ParseError & e) {
+			buffer_error = e.what();
+		}
+		for (std::size_t size = 1; size <= 2; ++size) {
+			try {
+				feed_in_chunks(json, size);
+			} catch (const rejson::ParseError & e) {
+				push_error = e.what();
+			}
+			EXPECT_FALSE(buffer_error.empty()) << json;
+			EXPECT_EQ(push_error, buffer_error) << json;
+		}
+	}
+}
+
+TEST(PushParserTests, TopLevelNumberEndsBeforeSign) {
+	rejson::ValueBuilder builder;
+	rejson::BasicPushParser<rejson::ValueBuilder> parser { builder };
+	EXPECT_EQ(parser.feed(rejson::detail::string_view { "1-5" }), 1);
+	EXPECT_TRUE(parser.done());
+	EXPECT_EQ(builder.take().as_int(), 1);
+	ASSERT_EQ(rejson::parse(rejson::detail::string_view { "1-5" }).as_int(), 1);
+}
+
+TEST(PushParserTests, ResetDiscardsPartialInput) {
+	rejson::PushParser parser;
+	parser.feed("[1, {\"a\": [");
+	parser.reset();
+	const auto values = parser.feed("[true]");
+	ASSERT_EQ(values.size(), 1);
+	ASSERT_EQ(values[0].as_array()[0].as_bool(), true);
+}
+
+TEST(PushParserTests, BasicPushParserStopsAfterValue) {
+	rejson::ValueBuilder builder;
+	rejson::BasicPushParser<rejson::ValueBuilder> parser { builder };
+	const rejson::detail::string_view input { "[1] [2]" };
+	EXPECT_EQ(parser.feed(input), 3);
+	EXPECT_TRUE(parser.done());
+	ASSERT_EQ(builder.take().as_array()[0].as_int(), 1);
+}
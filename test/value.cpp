@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include <rejson/value.hpp>
 
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
 TEST(ValueTests, IsNullReturnsTrueIfEmpty) {
 	ASSERT_TRUE(rejson::Value().is_null());
 }
@@ -59,3 +65,95 @@ TEST(ValueTests, ToJsonValueWorks) {
 	const auto & bar = foo.at("bar");
 	ASSERT_EQ(bar.as_int(), expected.bar);
 }
+
+TEST(ValueTests, AsIntThrowsIfNotInt) {
+	ASSERT_THROW({
+		rejson::Value("abc").as_int();
+	}, rejson::TypeError);
+}
+
+TEST(ValueTests, StdStringValueIsString) {
+	const rejson::Value value = std::string("abc");
+	EXPECT_TRUE(value.is_string());
+	ASSERT_EQ(value.as_string(), "abc");
+}
+
+TEST(ValueTests, MapValueIsObject) {
+	const std::map<std::string, int> map { { "foo", 123 } };
+	const rejson::Value value = map;
+	ASSERT_EQ(value.as_object().at("foo").as_int(), 123);
+}
+
+TEST(ValueTests, CopiedValueIsIndependent) {
+	rejson::Value value = rejson::Array { 1, 2, 3 };
+	const rejson::Value copy = value;
+	value.as_array().clear();
+	ASSERT_EQ(copy.as_array().size(), 3);
+}
+
+TEST(ValueTests, MovedFromValueIsNull) {
+	rejson::Value value = "abc";
+	const rejson::Value other = std::move(value);
+	EXPECT_TRUE(value.is_null());
+	ASSERT_EQ(other.as_string(), "abc");
+}
+
+TEST(ValueTests, ConstructFromOtherIntegersWorks) {
+	EXPECT_EQ(rejson::Value(42).as_int(), 42);
+	EXPECT_EQ(rejson::Value(short { -3 }).as_int(), -3);
+	EXPECT_EQ(rejson::Value(7u).as_int(), 7);
+	ASSERT_EQ(rejson::Value(INT64_MIN).as_int(), INT64_MIN);
+}
+
+TEST(ValueTests, ValueTakesSixteenBytes) {
+	ASSERT_EQ(sizeof(rejson::Value), 16);
+}
+
+TEST(ValueTests, ShortStringIsInline) {
+	const rejson::String str = "fourteen chars";
+	EXPECT_EQ(str.capacity(), rejson::String::inline_capacity);
+	EXPECT_EQ(str.data(), reinterpret_cast<const char *>(&str));
+	ASSERT_EQ(str, "fourteen chars");
+}
+
+TEST(ValueTests, LongStringGrowsOutOfInlineBuffer) {
+	rejson::String str = "abc";
+	for (int i = 0; i < 10; ++i)
+		str += "0123456789";
+	str.append(str.data(), 3);
+	EXPECT_EQ(str.size(), 106);
+	EXPECT_EQ(str.c_str()[str.size()], '\0');
+	ASSERT_EQ(str.to_string().substr(100), "789abc");
+}
+
+TEST(ValueTests, ArrayOperationsWork) {
+	rejson::Array array { 1, "abc" };
+	for (int i = 0; i < 10; ++i)
+		array.push_back(array[0]);
+	array.pop_back();
+	EXPECT_EQ(array.size(), 11);
+	EXPECT_EQ(array.back().as_int(), 1);
+	EXPECT_EQ(array.at(1).as_string(), "abc");
+	ASSERT_THROW(array.at(11), std::out_of_range);
+}
+
+TEST(ValueTests, ObjectKeepsInsertionOrder) {
+	rejson::Object object { { "b", 1 }, { "a", 2 } };
+	object["c"] = 3;
+	std::string keys;
+	for (auto && member : object)
+		keys += member.first.to_string();
+	ASSERT_EQ(keys, "bac");
+}
+
+TEST(ValueTests, LargeObjectLookupWorks) {
+	rejson::Object object;
+	for (int i = 0; i < 100; ++i)
+		object.emplace(std::to_string(i), i);
+	EXPECT_GT(object.size(), rejson::Object::small_size);
+	EXPECT_FALSE(object.emplace("42", 0).second);
+	EXPECT_EQ(object.erase("10"), 1);
+	EXPECT_EQ(object.count("10"), 0);
+	EXPECT_EQ(object.at(rejson::detail::string_view("99")).as_int(), 99);
+	ASSERT_EQ(object.begin()[10].first, "11");
+}